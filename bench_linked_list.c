@@ -0,0 +1,437 @@
+#include "linked_list.h"
+#include "lf_list.h"
+#include "list_parallel.h"
+#include "rcu_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "memory_manager.h"
+#include "common_defs.h"
+#include "gitdata.h"
+
+static double now_seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// ********* Lock-free list throughput *********
+
+#define LF_BENCH_KEYS 1024
+
+typedef struct
+{
+    LfList *list;
+    int id;
+    long ops;
+    int update_percent;
+    pthread_barrier_t *start;
+} LfBenchArgs;
+
+static void *lf_bench_worker(void *arg)
+{
+    LfBenchArgs *a = (LfBenchArgs *)arg;
+    unsigned int seed = 12345u + a->id * 7919u;
+
+    pthread_barrier_wait(a->start);
+    for (long i = 0; i < a->ops; i++)
+    {
+        int r = rand_r(&seed);
+        uint16_t key = (uint16_t)((r >> 8) % LF_BENCH_KEYS);
+        int op = r % 100;
+        if (op < a->update_percent / 2)
+        {
+            lf_list_insert(a->list, key);
+        }
+        else if (op < a->update_percent)
+        {
+            lf_list_delete(a->list, key);
+        }
+        else
+        {
+            lf_list_contains(a->list, key);
+        }
+    }
+    return NULL;
+}
+
+void bench_lf_list(int max_threads, long ops_per_thread, int update_percent)
+{
+    printf_yellow("  Lock-free list, %d%% updates, %ld ops per thread:\n", update_percent, ops_per_thread);
+
+    for (int nthreads = 1; nthreads <= max_threads; nthreads *= 2)
+    {
+        LfList list;
+        lf_list_init(&list, sizeof(LfNode) * LF_BENCH_KEYS * 16);
+        for (int k = 0; k < LF_BENCH_KEYS; k += 2)
+        {
+            lf_list_insert(&list, k);
+        }
+
+        pthread_t threads[nthreads];
+        LfBenchArgs args[nthreads];
+        pthread_barrier_t start;
+        pthread_barrier_init(&start, NULL, nthreads + 1);
+        for (int t = 0; t < nthreads; t++)
+        {
+            args[t] = (LfBenchArgs){&list, t, ops_per_thread, update_percent, &start};
+            pthread_create(&threads[t], NULL, lf_bench_worker, &args[t]);
+        }
+
+        pthread_barrier_wait(&start);
+        double begin = now_seconds();
+        for (int t = 0; t < nthreads; t++)
+        {
+            pthread_join(threads[t], NULL);
+        }
+        double elapsed = now_seconds() - begin;
+        pthread_barrier_destroy(&start);
+
+        printf("    %3d thread(s): %10.0f ops/s\n", nthreads, nthreads * ops_per_thread / elapsed);
+        lf_list_cleanup(&list);
+    }
+}
+
+// ********* Parallel traversal *********
+
+static uint64_t sum_values(uint64_t acc, uint64_t value)
+{
+    return acc + value;
+}
+
+void bench_list_parallel(int max_threads, long count)
+{
+    printf_yellow("  Parallel traversal of %ld nodes:\n", count);
+    Node *head = NULL;
+    uint16_t *values = malloc(count * sizeof(uint16_t));
+    for (long i = 0; i < count; i++)
+    {
+        values[i] = (uint16_t)(i * 2654435761u >> 16);
+    }
+
+    // Shuffle the physical order so that traversal is latency bound
+    list_init(&head, count * sizeof(Node));
+    list_insert_array(&head, values, count);
+    long *order = malloc(count * sizeof(long));
+    for (long i = 0; i < count; i++)
+    {
+        order[i] = i;
+    }
+    unsigned int seed = 42;
+    for (long i = count - 1; i > 0; i--)
+    {
+        long j = rand_r(&seed) % (i + 1);
+        long tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    for (long i = 0; i < count; i++)
+    {
+        head[order[i]].next = i + 1 < count ? &head[order[i + 1]] : NULL;
+    }
+    head = &head[order[0]];
+
+    double begin = now_seconds();
+    int sequential = list_count_nodes(&head);
+    double base = now_seconds() - begin;
+    printf("    list_count_nodes: %8.3f s (%d nodes)\n", base, sequential);
+
+    ListIndex index;
+    begin = now_seconds();
+    list_index_build(&index, &head, LIST_INDEX_STRIDE);
+    printf("    list_index_build: %8.3f s (%zu segments)\n", now_seconds() - begin, index.count);
+
+    for (int nthreads = 1; nthreads <= max_threads; nthreads *= 2)
+    {
+        list_parallel_set_threads(nthreads);
+        list_count(&index); // Start the pool outside the measurement
+
+        begin = now_seconds();
+        size_t counted = list_count(&index);
+        double elapsed = now_seconds() - begin;
+
+        begin = now_seconds();
+        uint64_t sum = list_reduce(&index, 0, sum_values, sum_values);
+        double reduce = now_seconds() - begin;
+
+        printf("    %3d thread(s): count %8.3f s (x%.1f), reduce %8.3f s [%zu, %lu]\n",
+               nthreads, elapsed, base / elapsed, reduce, counted, (unsigned long)sum);
+    }
+
+    list_parallel_shutdown();
+    list_index_free(&index);
+    mem_deinit();
+    free(order);
+    free(values);
+}
+
+// ********* Sorting *********
+
+void bench_list_sort(long count)
+{
+    printf_yellow("  Sorting %ld nodes:\n", count);
+    Node *head = NULL;
+    uint16_t *values = malloc(count * sizeof(uint16_t));
+    unsigned int seed = 7;
+    for (long i = 0; i < count; i++)
+    {
+        values[i] = (uint16_t)rand_r(&seed);
+    }
+
+    list_from_array(&head, values, count);
+    double begin = now_seconds();
+    list_sort(&head);
+    double random_input = now_seconds() - begin;
+
+    // Sorting again: the input is sorted but the nodes are now scattered in memory
+    begin = now_seconds();
+    list_sort(&head);
+    double sorted_input = now_seconds() - begin;
+    printf("    list_sort: random %8.3f s, already sorted %8.3f s\n", random_input, sorted_input);
+    list_cleanup(&head);
+
+    // Merge two sorted halves
+    list_init(&head, count * sizeof(Node));
+    Node *other = NULL;
+    list_insert_array(&head, values, count / 2);
+    list_insert_array(&other, values + count / 2, count - count / 2);
+    list_sort(&head);
+    list_sort(&other);
+    begin = now_seconds();
+    list_merge(&head, &other);
+    printf("    list_merge of two sorted halves: %8.3f s\n", now_seconds() - begin);
+    list_cleanup(&head);
+
+    free(values);
+}
+
+// ********* Read-mostly list *********
+
+#define RCU_BENCH_KEYS 1024
+
+typedef struct
+{
+    RcuList *list;
+    int id;
+    long ops;
+    _Atomic int *stop;
+    pthread_barrier_t *start;
+} RcuBenchArgs;
+
+static void *rcu_bench_reader(void *arg)
+{
+    RcuBenchArgs *a = (RcuBenchArgs *)arg;
+    unsigned int seed = 777u + a->id * 7919u;
+
+    pthread_barrier_wait(a->start);
+    for (long i = 0; i < a->ops; i++)
+    {
+        rcu_list_contains(a->list, (uint16_t)(rand_r(&seed) % RCU_BENCH_KEYS));
+    }
+    return NULL;
+}
+
+// One writer keeps replacing values until every reader is done
+static void *rcu_bench_writer(void *arg)
+{
+    RcuBenchArgs *a = (RcuBenchArgs *)arg;
+    unsigned int seed = 4242u;
+    long updates = 0;
+
+    pthread_barrier_wait(a->start);
+    while (!atomic_load(a->stop))
+    {
+        uint16_t key = (uint16_t)(rand_r(&seed) % RCU_BENCH_KEYS);
+        rcu_list_replace(a->list, key, key);
+        updates++;
+    }
+    a->ops = updates;
+    return NULL;
+}
+
+void bench_rcu_list(int max_threads, long ops_per_thread)
+{
+    printf_yellow("  Read-mostly list, one writer, %ld lookups per reader:\n", ops_per_thread);
+
+    for (int nthreads = 1; nthreads <= max_threads; nthreads *= 2)
+    {
+        RcuList list;
+        rcu_list_init(&list, sizeof(RcuNode) * RCU_BENCH_KEYS * 16);
+        for (int k = 0; k < RCU_BENCH_KEYS; k++)
+        {
+            rcu_list_insert(&list, k);
+        }
+
+        _Atomic int stop = 0;
+        pthread_t readers[nthreads];
+        pthread_t writer;
+        RcuBenchArgs args[nthreads + 1];
+        pthread_barrier_t start;
+        pthread_barrier_init(&start, NULL, nthreads + 2);
+        for (int t = 0; t <= nthreads; t++)
+        {
+            args[t] = (RcuBenchArgs){&list, t, ops_per_thread, &stop, &start};
+        }
+        for (int t = 0; t < nthreads; t++)
+        {
+            pthread_create(&readers[t], NULL, rcu_bench_reader, &args[t]);
+        }
+        pthread_create(&writer, NULL, rcu_bench_writer, &args[nthreads]);
+
+        pthread_barrier_wait(&start);
+        double begin = now_seconds();
+        for (int t = 0; t < nthreads; t++)
+        {
+            pthread_join(readers[t], NULL);
+        }
+        double elapsed = now_seconds() - begin;
+        atomic_store(&stop, 1);
+        pthread_join(writer, NULL);
+        pthread_barrier_destroy(&start);
+
+        printf("    %3d reader(s): %10.0f lookups/s, %10.0f updates/s\n", nthreads,
+               nthreads * ops_per_thread / elapsed, args[nthreads].ops / elapsed);
+        rcu_list_cleanup(&list);
+    }
+}
+
+// ********* Allocator latency *********
+
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void print_latency(const char *name, double *samples, long n)
+{
+    qsort(samples, n, sizeof(double), compare_doubles);
+    printf("    %-9s p50 %8.0f ns, p99 %8.0f ns, p99.9 %8.0f ns, max %8.0f ns\n", name,
+           samples[n / 2] * 1e9, samples[n * 99 / 100] * 1e9, samples[n * 999 / 1000] * 1e9,
+           samples[n - 1] * 1e9);
+}
+
+// Worst case for a list walk: the first half of the pool is cut into thousands of
+// 16-byte holes that no request above 16 bytes fits in, so every such request
+// has to get past all of them. Run it against each allocator library with
+// LD_LIBRARY_PATH to compare.
+void bench_alloc_latency(long ops)
+{
+    const size_t pool = 4 << 20;
+    const size_t sizes[] = {16, 32, 64, 256, 1024, 4096};
+    const int live_max = 1024;
+    printf_yellow("  Allocator latency under fragmentation, %ld operations:\n", ops);
+
+    mem_init(pool);
+    long pairs = pool / 2 / 64;
+    void **holes = malloc(pairs * sizeof(void *));
+    void **kept = malloc(pairs * sizeof(void *));
+    for (long i = 0; i < pairs; i++)
+    {
+        holes[i] = mem_alloc(16);
+        kept[i] = mem_alloc(48);
+    }
+    for (long i = 0; i < pairs; i++)
+    {
+        mem_free(holes[i]);
+    }
+
+    double *alloc_times = malloc(ops * sizeof(double));
+    double *free_times = malloc(ops * sizeof(double));
+    void *live[live_max];
+    int live_count = 0;
+    long allocs = 0, frees = 0;
+    unsigned int seed = 2024;
+
+    for (long i = 0; i < ops; i++)
+    {
+        size_t size = sizes[rand_r(&seed) % (sizeof(sizes) / sizeof(sizes[0]))];
+        double begin = now_seconds();
+        void *p = mem_alloc(size);
+        alloc_times[allocs++] = now_seconds() - begin;
+        if (p != NULL)
+        {
+            live[live_count++] = p;
+        }
+
+        // Free a random live block when the working set is full, or now and then
+        if (live_count == live_max || (live_count > 0 && rand_r(&seed) % 2))
+        {
+            int victim = rand_r(&seed) % live_count;
+            begin = now_seconds();
+            mem_free(live[victim]);
+            free_times[frees++] = now_seconds() - begin;
+            live[victim] = live[--live_count];
+        }
+    }
+
+    print_latency("mem_alloc", alloc_times, allocs);
+    print_latency("mem_free", free_times, frees);
+
+    mem_deinit();
+    free(alloc_times);
+    free(free_times);
+    free(holes);
+    free(kept);
+}
+
+int main(int argc, char *argv[])
+{
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+
+    int cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (argc < 2)
+    {
+        printf("Usage: %s <benchmark> [size]\n", argv[0]);
+        printf("Available benchmarks:\n");
+        printf(" 1. bench_lf_list - Lock-free list throughput, 1..%d threads, read-mostly and update-heavy\n", cores);
+        printf(" 2. bench_list_parallel - Parallel count and reduce over a shuffled list, 1..%d threads\n", cores);
+        printf(" 3. bench_list_sort - list_sort and list_merge, default 10^6 and 10^7 nodes\n");
+        printf(" 4. bench_rcu_list - Read-mostly list lookups against one writer, 1..%d readers\n", cores);
+        printf(" 5. bench_alloc_latency - mem_alloc/mem_free latency percentiles under fragmentation\n");
+        printf(" 0. Run all benchmarks\n");
+        return 1;
+    }
+
+    long size = argc > 2 ? atol(argv[2]) : 0;
+    int which = atoi(argv[1]);
+
+    if (which == 0 || which == 1)
+    {
+        bench_lf_list(cores, size ? size : 200000, 10);
+        bench_lf_list(cores, size ? size : 200000, 50);
+    }
+    if (which == 0 || which == 2)
+    {
+        bench_list_parallel(cores, size ? size : 10000000);
+    }
+    if (which == 0 || which == 3)
+    {
+        if (size)
+        {
+            bench_list_sort(size);
+        }
+        else
+        {
+            bench_list_sort(1000000);
+            bench_list_sort(10000000);
+        }
+    }
+    if (which == 0 || which == 4)
+    {
+        bench_rcu_list(cores, size ? size : 100000);
+    }
+    if (which == 0 || which == 5)
+    {
+        bench_alloc_latency(size ? size : 10000);
+    }
+    return 0;
+}
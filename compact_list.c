@@ -0,0 +1,271 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "memory_manager.h"
+#include "compact_list.h"
+#include "list_format.h"
+
+// Antal noder som hämtas från poolen åt gången när listan växer
+#define CLIST_CHUNK_NODES 4096
+
+// Varje chunk börjar med förskjutningen till föregående chunk, noderna följer direkt efter
+typedef struct __attribute__((packed)) CChunk {
+    uint32_t next;
+} CChunk;
+
+// Översätt en förskjutning till en nodpekare relativt poolens bas
+#define NODE(base, ref) ((CNode*) ((base) + (ref)))
+
+// Hämta en ny chunk från poolen. Får inte hela storleken plats, halvera tills det går.
+static int add_chunk(CList* list, size_t nodes) {
+    char* base = (char*) mem_pool_base();
+
+    while (nodes > 0) {
+        size_t bytes = sizeof(CChunk) + nodes * sizeof(CNode);
+        char* chunk = (char*) mem_alloc(bytes);
+        if (chunk) {
+            size_t offset = (size_t) (chunk - base);
+            if (offset + bytes >= CLIST_NIL) {
+                mem_free(chunk);  // Utanför vad en 32-bitars förskjutning kan adressera
+                return 0;
+            }
+            ((CChunk*) chunk)->next = list->chunks;
+            list->chunks = (uint32_t) offset;
+            list->bump = (uint32_t) (offset + sizeof(CChunk));
+            list->bump_end = (uint32_t) (offset + bytes);
+            return 1;
+        }
+        nodes /= 2;
+    }
+    return 0;
+}
+
+// Ta en nod från listan av frigjorda noder, annars nästa oanvända nod i senaste chunken
+static CNodeRef alloc_node(CList* list) {
+    char* base = (char*) mem_pool_base();
+
+    if (list->free_nodes != CLIST_NIL) {
+        CNodeRef ref = list->free_nodes;
+        list->free_nodes = NODE(base, ref)->next;
+        return ref;
+    }
+    if (list->bump == list->bump_end && !add_chunk(list, CLIST_CHUNK_NODES)) {
+        return CLIST_NIL;
+    }
+    CNodeRef ref = list->bump;
+    list->bump += sizeof(CNode);
+    return ref;
+}
+
+static void release_node(CList* list, CNodeRef ref) {
+    char* base = (char*) mem_pool_base();
+    NODE(base, ref)->next = list->free_nodes;
+    list->free_nodes = ref;
+}
+
+// Skapar en tom lista i en redan initierad pool
+void clist_new(CList* list) {
+    list->head = CLIST_NIL;
+    list->tail = CLIST_NIL;
+    list->free_nodes = CLIST_NIL;
+    list->chunks = CLIST_NIL;
+    list->bump = 0;
+    list->bump_end = 0;
+}
+
+// The function sets up the list and a pool with room for size bytes of nodes
+void clist_init(CList* list, size_t size) {
+    mem_init(size + sizeof(CChunk));
+    clist_new(list);
+    add_chunk(list, size / sizeof(CNode));  // Hela poolen blir en enda chunk
+}
+
+CNode* clist_node(CNodeRef ref) {
+    if (ref == CLIST_NIL) {
+        return NULL;
+    }
+    return NODE((char*) mem_pool_base(), ref);
+}
+
+void clist_insert(CList* list, uint16_t data) {
+    CNodeRef ref = alloc_node(list);
+    if (ref == CLIST_NIL) {
+        mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);
+        return;
+    }
+
+    char* base = (char*) mem_pool_base();
+    NODE(base, ref)->data = data;
+    NODE(base, ref)->next = CLIST_NIL;
+
+    // Listan håller reda på sista noden, så insättning sist kräver ingen genomgång
+    if (list->head == CLIST_NIL) {
+        list->head = ref;
+    } else {
+        NODE(base, list->tail)->next = ref;
+    }
+    list->tail = ref;
+}
+
+void clist_insert_after(CList* list, CNodeRef prev_node, uint16_t data) {
+    if (prev_node == CLIST_NIL) {
+        mem_report(MEM_ERR_NULL_NODE, NULL);
+        return;
+    }
+
+    CNodeRef ref = alloc_node(list);
+    if (ref == CLIST_NIL) {
+        mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);
+        return;
+    }
+
+    char* base = (char*) mem_pool_base();
+    NODE(base, ref)->data = data;
+    NODE(base, ref)->next = NODE(base, prev_node)->next;
+    NODE(base, prev_node)->next = ref;
+    if (list->tail == prev_node) {
+        list->tail = ref;
+    }
+}
+
+void clist_insert_before(CList* list, CNodeRef next_node, uint16_t data) {
+    if (next_node == CLIST_NIL) {
+        mem_report(MEM_ERR_NULL_NODE, NULL);
+        return;
+    }
+
+    char* base = (char*) mem_pool_base();
+
+    // Om next_node är huvudnoden blir den nya noden ny huvudnod
+    CNodeRef current = CLIST_NIL;
+    if (list->head != next_node) {
+        current = list->head;
+        while (current != CLIST_NIL && NODE(base, current)->next != next_node) {
+            current = NODE(base, current)->next;
+        }
+        if (current == CLIST_NIL) {
+            mem_report(MEM_ERR_NODE_NOT_IN_LIST, NODE(base, next_node));
+            return;
+        }
+    }
+
+    CNodeRef ref = alloc_node(list);
+    if (ref == CLIST_NIL) {
+        mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);
+        return;
+    }
+    NODE(base, ref)->data = data;
+    NODE(base, ref)->next = next_node;
+
+    if (current == CLIST_NIL) {
+        list->head = ref;
+    } else {
+        NODE(base, current)->next = ref;
+    }
+}
+
+void clist_delete(CList* list, uint16_t data) {
+    if (list->head == CLIST_NIL) {
+        mem_report(MEM_ERR_LIST_EMPTY, NULL);
+        return;
+    }
+
+    char* base = (char*) mem_pool_base();
+    CNodeRef current = list->head;
+    CNodeRef previous = CLIST_NIL;
+
+    // Leta efter noden med den specifika datan
+    while (current != CLIST_NIL && NODE(base, current)->data != data) {
+        previous = current;
+        current = NODE(base, current)->next;
+    }
+
+    if (current == CLIST_NIL) {
+        mem_report(MEM_ERR_DATA_NOT_FOUND, NULL);
+        return;
+    }
+
+    if (previous == CLIST_NIL) {
+        list->head = NODE(base, current)->next;
+    } else {
+        NODE(base, previous)->next = NODE(base, current)->next;
+    }
+    if (list->tail == current) {
+        list->tail = previous;
+    }
+
+    release_node(list, current);
+}
+
+CNodeRef clist_search(CList* list, uint16_t data) {
+    char* base = (char*) mem_pool_base();
+    CNodeRef current = list->head;
+    while (current != CLIST_NIL) {
+        if (NODE(base, current)->data == data) {
+            return current;
+        }
+        current = NODE(base, current)->next;
+    }
+    return CLIST_NIL;
+}
+
+// Samma buffrade formatering som list_display, utan printf per element
+void clist_display_range(CList* list, CNodeRef start_node, CNodeRef end_node) {
+    char* base = (char*) mem_pool_base();
+    CNodeRef current = start_node != CLIST_NIL ? start_node : list->head;
+    CNodeRef stop = end_node != CLIST_NIL ? NODE(base, end_node)->next : CLIST_NIL;
+    char buf[LIST_WRITE_BUFFER];
+    size_t used = 0;
+    int fd = fileno(stdout);
+
+    fflush(stdout);  // Bevara ordningen mot text som redan ligger i stdio-bufferten
+    buf[used++] = '[';
+    while (current != CLIST_NIL && (end_node == CLIST_NIL || current != stop)) {
+        if (sizeof(buf) - used < LIST_MAX_ELEMENT_TEXT + 1) {
+            if (list_fd_sink(&fd, buf, used) != 0) {
+                return;
+            }
+            used = 0;
+        }
+        CNode* node = NODE(base, current);
+        used += list_u16_to_ascii(node->data, buf + used);
+        if (node->next != CLIST_NIL && current != end_node) {
+            buf[used++] = ',';
+            buf[used++] = ' ';
+        }
+        current = node->next;
+    }
+    buf[used++] = ']';
+    list_fd_sink(&fd, buf, used);
+}
+
+void clist_display(CList* list) {
+    clist_display_range(list, CLIST_NIL, CLIST_NIL);
+}
+
+int clist_count_nodes(CList* list) {
+    char* base = (char*) mem_pool_base();
+    int count = 0;
+    CNodeRef current = list->head;
+    while (current != CLIST_NIL) {
+        count++;
+        current = NODE(base, current)->next;
+    }
+    return count;
+}
+
+// Lämnar tillbaka alla chunkar till poolen, listan blir tom men poolen lever vidare
+void clist_destroy(CList* list) {
+    char* base = (char*) mem_pool_base();
+    uint32_t chunk = list->chunks;
+    while (chunk != CLIST_NIL) {
+        uint32_t next = ((CChunk*) (base + chunk))->next;
+        mem_free(base + chunk);
+        chunk = next;
+    }
+    clist_new(list);
+}
+
+void clist_cleanup(CList* list) {
+    clist_destroy(list);
+    mem_deinit();  // Avslutar minneshanteraren
+}
@@ -0,0 +1,49 @@
+#ifndef COMPACT_LIST_H
+#define COMPACT_LIST_H
+#include <stddef.h>  // For size_t
+
+#include <stdint.h>  // For uint16_t, uint32_t
+
+// Compact variant of the linked list: nodes link to each other with 32-bit
+// byte offsets from mem_pool_base() instead of 64-bit pointers, and are packed
+// to 6 bytes. Nodes are carved out of larger chunks taken from the pool, so the
+// allocator's per-block metadata is paid once per chunk, not once per node.
+// Offsets limit the pool to 4 GiB.
+
+// Offset that means "no node", the counterpart of NULL
+#define CLIST_NIL UINT32_MAX
+
+typedef uint32_t CNodeRef;
+
+typedef struct __attribute__((packed)) CNode {
+    uint32_t next;  // Offset of the next node, or CLIST_NIL
+    uint16_t data;
+} CNode;
+
+// All fields are offsets, so a CList placed inside the pool stays valid
+// wherever the pool is mapped.
+typedef struct CList {
+    CNodeRef head;
+    CNodeRef tail;
+    CNodeRef free_nodes;  // Released nodes, linked through their next field
+    uint32_t chunks;      // First chunk taken from the pool, for clist_destroy
+    uint32_t bump;        // Next never-used node in the newest chunk
+    uint32_t bump_end;    // End of the newest chunk
+} CList;
+
+// Function prototypes
+void clist_init(CList* list, size_t size);
+void clist_new(CList* list);
+void clist_insert(CList* list, uint16_t data);
+void clist_insert_after(CList* list, CNodeRef prev_node, uint16_t data);
+void clist_insert_before(CList* list, CNodeRef next_node, uint16_t data);
+void clist_delete(CList* list, uint16_t data);
+CNodeRef clist_search(CList* list, uint16_t data);
+void clist_display(CList* list);
+void clist_display_range(CList* list, CNodeRef start_node, CNodeRef end_node);
+int clist_count_nodes(CList* list);
+CNode* clist_node(CNodeRef ref);
+void clist_destroy(CList* list);
+void clist_cleanup(CList* list);
+
+#endif  // COMPACT_LIST_H
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include "memory_manager.h"
+#include "epoch.h"
+
+// Hur ofta (antal ebr_retire) en tråd försöker flytta fram epoken och tömma sina påsar
+#define EBR_COLLECT_INTERVAL 64
+
+// Noder som tagits bort under en viss epok och väntar på att få frigöras
+typedef struct {
+    uint64_t epoch;
+    void** items;
+    size_t count;
+    size_t capacity;
+} LimboBag;
+
+// En plats per registrerad tråd. Tre påsar räcker: en nod som togs bort i epok e
+// är säker att frigöra när den globala epoken har nått e + 2.
+typedef struct {
+    _Atomic uint64_t state;  // (epok << 1) | 1 medan tråden är i en kritisk sektion, annars 0
+    atomic_int in_use;
+    LimboBag bags[3];
+    unsigned retire_count;
+} __attribute__((aligned(64))) EbrSlot;
+
+static _Atomic uint64_t global_epoch = 0;
+static EbrSlot slots[EBR_MAX_THREADS];
+
+static __thread EbrSlot* my_slot = NULL;
+static pthread_key_t slot_key;
+static pthread_once_t slot_key_once = PTHREAD_ONCE_INIT;
+
+// Körs när en tråd avslutas: platsen lämnas tillbaka men påsarna ärvs av nästa ägare
+static void release_slot(void* arg) {
+    EbrSlot* slot = (EbrSlot*) arg;
+    atomic_store(&slot->state, 0);
+    atomic_store(&slot->in_use, 0);
+}
+
+static void create_slot_key(void) {
+    pthread_key_create(&slot_key, release_slot);
+}
+
+static EbrSlot* get_slot(void) {
+    if (my_slot != NULL) {
+        return my_slot;
+    }
+
+    pthread_once(&slot_key_once, create_slot_key);
+    for (int i = 0; i < EBR_MAX_THREADS; i++) {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&slots[i].in_use, &expected, 1)) {
+            my_slot = &slots[i];
+            pthread_setspecific(slot_key, my_slot);
+            return my_slot;
+        }
+    }
+
+    fprintf(stderr, "Fel: Fler än %d trådar använder epokhanteringen.\n", EBR_MAX_THREADS);
+    exit(EXIT_FAILURE);
+}
+
+static void free_bag(LimboBag* bag) {
+    for (size_t i = 0; i < bag->count; i++) {
+        mem_free(bag->items[i]);
+    }
+    bag->count = 0;
+}
+
+// Flytta fram den globala epoken om alla aktiva trådar har sett den nuvarande
+static void try_advance(void) {
+    uint64_t epoch = atomic_load(&global_epoch);
+    for (int i = 0; i < EBR_MAX_THREADS; i++) {
+        if (!atomic_load(&slots[i].in_use)) {
+            continue;
+        }
+        uint64_t state = atomic_load(&slots[i].state);
+        if ((state & 1) && (state >> 1) != epoch) {
+            return;  // En läsare ligger kvar i en äldre epok
+        }
+    }
+    atomic_compare_exchange_strong(&global_epoch, &epoch, epoch + 1);
+}
+
+void ebr_enter(void) {
+    EbrSlot* slot = get_slot();
+    uint64_t epoch;
+
+    // Endast laddningar och lagringar, inga atomiska läs-modifiera-skriv.
+    // Om epoken flyttades medan vi publicerade vår, publicera igen.
+    do {
+        epoch = atomic_load(&global_epoch);
+        atomic_store(&slot->state, (epoch << 1) | 1);
+    } while (atomic_load(&global_epoch) != epoch);
+}
+
+void ebr_exit(void) {
+    atomic_store_explicit(&my_slot->state, 0, memory_order_release);
+}
+
+void ebr_retire(void* ptr) {
+    EbrSlot* slot = get_slot();
+    uint64_t epoch = atomic_load(&global_epoch);
+    LimboBag* bag = &slot->bags[epoch % 3];
+
+    // Påsen återanvänds tre epoker senare, då är allt i den säkert att frigöra
+    if (bag->epoch != epoch) {
+        free_bag(bag);
+        bag->epoch = epoch;
+    }
+
+    if (bag->count == bag->capacity) {
+        size_t capacity = bag->capacity ? bag->capacity * 2 : 64;
+        void** items = (void**) realloc(bag->items, capacity * sizeof(void*));
+        if (!items) {
+            perror("Misslyckades med att växa listan av borttagna noder");
+            exit(EXIT_FAILURE);
+        }
+        bag->items = items;
+        bag->capacity = capacity;
+    }
+    bag->items[bag->count++] = ptr;
+
+    if (++slot->retire_count % EBR_COLLECT_INTERVAL == 0) {
+        ebr_collect();
+    }
+}
+
+// Frigör de påsar i platsen vars noder ingen läsare längre kan se
+static void collect_slot(EbrSlot* slot, uint64_t epoch) {
+    for (int i = 0; i < 3; i++) {
+        LimboBag* bag = &slot->bags[i];
+        if (bag->count > 0 && bag->epoch + 2 <= epoch) {
+            free_bag(bag);
+        }
+    }
+}
+
+void ebr_collect(void) {
+    EbrSlot* slot = get_slot();
+    try_advance();
+    collect_slot(slot, atomic_load(&global_epoch));
+}
+
+// Väntar ut en grace period och frigör sedan det som den här tråden har lämnat bort,
+// samt påsar som avslutade trådar lämnat kvar. Påsar hos levande trådar ägs av dem.
+// Får inte anropas mellan ebr_enter och ebr_exit, då väntar tråden på sig själv.
+void ebr_synchronize(void) {
+    uint64_t target = atomic_load(&global_epoch) + 2;
+    while (atomic_load(&global_epoch) < target) {
+        try_advance();
+        if (atomic_load(&global_epoch) < target) {
+            sched_yield();  // Ge läsarna tid att lämna sina kritiska sektioner
+        }
+    }
+    ebr_collect();
+
+    // En ledig plats lånas medan dess påsar töms, så att ingen ny tråd tar den samtidigt
+    uint64_t epoch = atomic_load(&global_epoch);
+    for (int i = 0; i < EBR_MAX_THREADS; i++) {
+        int expected = 0;
+        if (&slots[i] != my_slot && atomic_compare_exchange_strong(&slots[i].in_use, &expected, 1)) {
+            collect_slot(&slots[i], epoch);
+            atomic_store(&slots[i].in_use, 0);
+        }
+    }
+}
+
+// Frigör allt som väntar, får bara anropas när inga andra trådar använder strukturerna
+void ebr_drain(void) {
+    for (int i = 0; i < EBR_MAX_THREADS; i++) {
+        for (int b = 0; b < 3; b++) {
+            LimboBag* bag = &slots[i].bags[b];
+            free_bag(bag);
+            free(bag->items);
+            bag->items = NULL;
+            bag->capacity = 0;
+        }
+    }
+}
+
+size_t ebr_pending(void) {
+    size_t pending = 0;
+    for (int i = 0; i < EBR_MAX_THREADS; i++) {
+        for (int b = 0; b < 3; b++) {
+            pending += slots[i].bags[b].count;
+        }
+    }
+    return pending;
+}
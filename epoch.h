@@ -0,0 +1,26 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+#include <stddef.h>  // For size_t
+
+// Epoch-based reclamation for lock-free structures built on the memory manager.
+// Readers wrap every traversal in ebr_enter()/ebr_exit(). Nodes unlinked by a
+// writer are handed to ebr_retire() and returned with mem_free() only after
+// every thread that could still see them has left its critical section.
+
+// Maximum number of threads that can be inside ebr_enter() at the same time
+#define EBR_MAX_THREADS 128
+
+void ebr_enter(void);
+void ebr_exit(void);
+void ebr_retire(void* ptr);
+void ebr_collect(void);
+// Blocks until a grace period has passed, then frees the nodes retired by this
+// thread and by threads that have exited. Nodes retired by other live threads
+// stay with them until they call ebr_collect() or ebr_synchronize(). Must not
+// be called between ebr_enter() and ebr_exit().
+void ebr_synchronize(void);
+void ebr_drain(void);
+// Retired nodes not yet freed, summed over all threads
+size_t ebr_pending(void);
+
+#endif  // EPOCH_H
@@ -0,0 +1,204 @@
+#ifndef GENERIC_LIST_H
+#define GENERIC_LIST_H
+#include <stddef.h>  // For size_t
+
+#include "memory_manager.h"
+
+// Type-generic singly linked list. DEFINE_LIST(name, type) expands to a node
+// type with the payload stored inline, a list that owns a fixed-size pool of
+// such nodes, and static inline functions prefixed with name_. The node layout
+// is known at compile time, so values are never boxed through void* and the
+// compiler can inline every operation.
+//
+// The pool is a single block taken from the memory manager, which aligns every
+// block for any type, so the payload may be a double, a pointer or any other
+// type. The list never grows beyond the capacity it was created with. Released nodes are reused
+// before untouched ones.
+//
+//     DEFINE_LIST(point_list, Point)
+//
+//     point_list list;
+//     point_list_init(&list, 1000);
+//     point_list_insert(&list, (Point) {1, 2});
+//     for (point_list_node* n = list.head; n != NULL; n = n->next) { ... }
+//     point_list_cleanup(&list);
+
+#define DEFINE_LIST(name, type)                                                     \
+    typedef struct name##_node {                                                    \
+        type data;                                                                  \
+        struct name##_node* next;                                                   \
+    } name##_node;                                                                  \
+                                                                                    \
+    typedef struct name {                                                           \
+        name##_node* head;                                                          \
+        name##_node* tail;                                                          \
+        name##_node* free_nodes; /* Released nodes, linked through next */          \
+        name##_node* nodes;      /* The pool, capacity nodes long */                \
+        size_t capacity;                                                            \
+        size_t used;             /* Nodes of the pool handed out at least once */   \
+        size_t count;                                                               \
+    } name;                                                                         \
+                                                                                    \
+    /* Returns non-zero for values that match */                                    \
+    typedef int (*name##_predicate)(const type* value, void* ctx);                  \
+                                                                                    \
+    /* Creates an empty list with room for capacity nodes in an existing pool */    \
+    static inline int name##_new(name* list, size_t capacity) {                     \
+        list->head = NULL;                                                          \
+        list->tail = NULL;                                                          \
+        list->free_nodes = NULL;                                                    \
+        list->capacity = 0;                                                         \
+        list->used = 0;                                                             \
+        list->count = 0;                                                            \
+        list->nodes = (name##_node*) mem_alloc(sizeof(name##_node) *                \
+                                               (capacity ? capacity : 1));          \
+        if (list->nodes == NULL) {                                                  \
+            return -1;                                                              \
+        }                                                                           \
+        list->capacity = capacity;                                                  \
+        return 0;                                                                   \
+    }                                                                               \
+                                                                                    \
+    /* Sets up the memory manager with exactly the room this list needs */          \
+    static inline int name##_init(name* list, size_t capacity) {                    \
+        mem_init(sizeof(name##_node) * (capacity ? capacity : 1));                  \
+        return name##_new(list, capacity);                                          \
+    }                                                                               \
+                                                                                    \
+    static inline name##_node* name##_alloc_node(name* list) {                      \
+        name##_node* node = list->free_nodes;                                       \
+        if (node != NULL) {                                                         \
+            list->free_nodes = node->next;                                          \
+        } else if (list->used < list->capacity) {                                   \
+            node = &list->nodes[list->used++];                                      \
+        }                                                                           \
+        return node;                                                                \
+    }                                                                               \
+                                                                                    \
+    static inline void name##_release_node(name* list, name##_node* node) {         \
+        node->next = list->free_nodes;                                              \
+        list->free_nodes = node;                                                    \
+        list->count--;                                                              \
+    }                                                                               \
+                                                                                    \
+    /* Appends a value, returns NULL when the pool is full */                       \
+    static inline name##_node* name##_insert(name* list, type value) {              \
+        name##_node* node = name##_alloc_node(list);                                \
+        if (node == NULL) {                                                         \
+            return NULL;                                                            \
+        }                                                                           \
+        node->data = value;                                                         \
+        node->next = NULL;                                                          \
+        if (list->head == NULL) {                                                   \
+            list->head = node;                                                      \
+        } else {                                                                    \
+            list->tail->next = node;                                                \
+        }                                                                           \
+        list->tail = node;                                                          \
+        list->count++;                                                              \
+        return node;                                                                \
+    }                                                                               \
+                                                                                    \
+    static inline name##_node* name##_push_front(name* list, type value) {          \
+        name##_node* node = name##_alloc_node(list);                                \
+        if (node == NULL) {                                                         \
+            return NULL;                                                            \
+        }                                                                           \
+        node->data = value;                                                         \
+        node->next = list->head;                                                    \
+        list->head = node;                                                          \
+        if (list->tail == NULL) {                                                   \
+            list->tail = node;                                                      \
+        }                                                                           \
+        list->count++;                                                              \
+        return node;                                                                \
+    }                                                                               \
+                                                                                    \
+    static inline name##_node* name##_insert_after(name* list, name##_node* prev,   \
+                                                   type value) {                    \
+        name##_node* node = name##_alloc_node(list);                                \
+        if (node == NULL) {                                                         \
+            return NULL;                                                            \
+        }                                                                           \
+        node->data = value;                                                         \
+        node->next = prev->next;                                                    \
+        prev->next = node;                                                          \
+        if (list->tail == prev) {                                                   \
+            list->tail = node;                                                      \
+        }                                                                           \
+        list->count++;                                                              \
+        return node;                                                                \
+    }                                                                               \
+                                                                                    \
+    /* Removes and returns the first value, returns 0 if the list is empty */       \
+    static inline int name##_pop_front(name* list, type* out) {                     \
+        name##_node* node = list->head;                                             \
+        if (node == NULL) {                                                         \
+            return 0;                                                               \
+        }                                                                           \
+        if (out != NULL) {                                                          \
+            *out = node->data;                                                      \
+        }                                                                           \
+        list->head = node->next;                                                    \
+        if (list->head == NULL) {                                                   \
+            list->tail = NULL;                                                      \
+        }                                                                           \
+        name##_release_node(list, node);                                            \
+        return 1;                                                                   \
+    }                                                                               \
+                                                                                    \
+    static inline name##_node* name##_find_if(name* list, name##_predicate pred,    \
+                                              void* ctx) {                          \
+        for (name##_node* node = list->head; node != NULL; node = node->next) {     \
+            if (pred(&node->data, ctx)) {                                           \
+                return node;                                                        \
+            }                                                                       \
+        }                                                                           \
+        return NULL;                                                                \
+    }                                                                               \
+                                                                                    \
+    /* Unlinks every matching node in one pass, returns how many were removed */    \
+    static inline size_t name##_remove_if(name* list, name##_predicate pred,        \
+                                          void* ctx) {                              \
+        size_t removed = 0;                                                         \
+        name##_node** link = &list->head;                                           \
+        name##_node* last = NULL;                                                   \
+        while (*link != NULL) {                                                     \
+            name##_node* node = *link;                                              \
+            if (pred(&node->data, ctx)) {                                           \
+                *link = node->next;                                                 \
+                name##_release_node(list, node);                                    \
+                removed++;                                                          \
+            } else {                                                                \
+                last = node;                                                        \
+                link = &node->next;                                                 \
+            }                                                                       \
+        }                                                                           \
+        list->tail = last;                                                          \
+        return removed;                                                             \
+    }                                                                               \
+                                                                                    \
+    static inline size_t name##_count(const name* list) {                           \
+        return list->count;                                                         \
+    }                                                                               \
+                                                                                    \
+    /* Empties the list and returns its pool; the memory manager lives on */        \
+    static inline void name##_destroy(name* list) {                                 \
+        if (list->nodes != NULL) {                                                  \
+            mem_free(list->nodes);                                                  \
+        }                                                                           \
+        list->nodes = NULL;                                                         \
+        list->head = NULL;                                                          \
+        list->tail = NULL;                                                          \
+        list->free_nodes = NULL;                                                    \
+        list->capacity = 0;                                                         \
+        list->used = 0;                                                             \
+        list->count = 0;                                                            \
+    }                                                                               \
+                                                                                    \
+    static inline void name##_cleanup(name* list) {                                 \
+        name##_destroy(list);                                                       \
+        mem_deinit();                                                               \
+    }
+
+#endif  // GENERIC_LIST_H
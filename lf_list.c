@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "memory_manager.h"
+#include "epoch.h"
+#include "lf_list.h"
+
+// Den lägsta biten i en next-pekare markerar att noden som äger pekaren är borttagen
+#define LF_MARK ((uintptr_t) 1)
+
+static inline int is_marked(uintptr_t link) {
+    return (link & LF_MARK) != 0;
+}
+
+static inline LfNode* node_of(uintptr_t link) {
+    return (LfNode*) (link & ~LF_MARK);
+}
+
+// Hitta den första noden vars data är >= data. I *prev_out lämnas länken som pekar på den.
+// Logiskt borttagna noder som passeras länkas ur fysiskt och lämnas till epokhanteringen.
+// Måste anropas mellan ebr_enter och ebr_exit.
+static LfNode* find(LfList* list, uint16_t data, _Atomic uintptr_t** prev_out) {
+try_again:;
+    _Atomic uintptr_t* prev = &list->head;
+    LfNode* current = node_of(atomic_load(prev));
+
+    while (current != NULL) {
+        uintptr_t next = atomic_load(&current->next);
+
+        // Om föregående nod har ändrats eller markerats sedan vi läste den, börja om
+        if (atomic_load(prev) != (uintptr_t) current) {
+            goto try_again;
+        }
+
+        if (!is_marked(next)) {
+            if (current->data >= data) {
+                break;  // Rätt position hittad
+            }
+            prev = &current->next;
+        } else {
+            // Noden är logiskt borttagen, försök länka ur den
+            uintptr_t expected = (uintptr_t) current;
+            if (!atomic_compare_exchange_strong(prev, &expected, next & ~LF_MARK)) {
+                goto try_again;
+            }
+            ebr_retire(current);  // Endast tråden vars CAS lyckades lämnar bort noden
+        }
+        current = node_of(next);
+    }
+
+    *prev_out = prev;
+    return current;
+}
+
+// The function sets up the list and prepares it for concurrent operations
+void lf_list_init(LfList* list, size_t size) {
+    atomic_store(&list->head, 0);
+    mem_init(size);
+}
+
+int lf_list_insert(LfList* list, uint16_t data) {
+    LfNode* new_node = NULL;
+    _Atomic uintptr_t* prev;
+    int inserted = 0;
+
+    ebr_enter();
+    for (;;) {
+        LfNode* current = find(list, data, &prev);
+        if (current != NULL && current->data == data) {
+            break;  // Värdet finns redan
+        }
+
+        // Allokera noden först när den verkligen behövs
+        if (new_node == NULL) {
+            new_node = (LfNode*) mem_alloc(sizeof(LfNode));
+            if (!new_node) {
+                mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);
+                ebr_exit();
+                return -1;
+            }
+            new_node->data = data;
+        }
+        atomic_store_explicit(&new_node->next, (uintptr_t) current, memory_order_relaxed);
+
+        // Publicera noden, CAS:en misslyckas om grannarna ändrades under tiden
+        uintptr_t expected = (uintptr_t) current;
+        if (atomic_compare_exchange_strong(prev, &expected, (uintptr_t) new_node)) {
+            new_node = NULL;
+            inserted = 1;
+            break;
+        }
+    }
+    ebr_exit();
+
+    if (new_node != NULL) {
+        mem_free(new_node);  // Noden publicerades aldrig, ingen annan tråd kan se den
+    }
+    return inserted;
+}
+
+int lf_list_delete(LfList* list, uint16_t data) {
+    _Atomic uintptr_t* prev;
+    int deleted = 0;
+
+    ebr_enter();
+    for (;;) {
+        LfNode* current = find(list, data, &prev);
+        if (current == NULL || current->data != data) {
+            break;  // Data hittades inte i listan
+        }
+
+        uintptr_t next = atomic_load(&current->next);
+        if (is_marked(next)) {
+            continue;  // En annan tråd tar redan bort noden
+        }
+
+        // Logisk borttagning: markera nodens next-pekare
+        if (!atomic_compare_exchange_strong(&current->next, &next, next | LF_MARK)) {
+            continue;
+        }
+        deleted = 1;
+
+        // Fysisk borttagning, misslyckas den städar nästa genomgång upp
+        uintptr_t expected = (uintptr_t) current;
+        if (atomic_compare_exchange_strong(prev, &expected, next)) {
+            ebr_retire(current);
+        } else {
+            find(list, data, &prev);
+        }
+        break;
+    }
+    ebr_exit();
+
+    return deleted;
+}
+
+int lf_list_contains(LfList* list, uint16_t data) {
+    int found = 0;
+
+    // Ren läsning utan några skrivningar till listan
+    ebr_enter();
+    LfNode* current = node_of(atomic_load(&list->head));
+    while (current != NULL && current->data < data) {
+        current = node_of(atomic_load(&current->next));
+    }
+    if (current != NULL && current->data == data) {
+        found = !is_marked(atomic_load(&current->next));
+    }
+    ebr_exit();
+
+    return found;
+}
+
+// Antalet noder som inte är markerade som borttagna, exakt endast när listan är i vila
+size_t lf_list_count_nodes(LfList* list) {
+    size_t count = 0;
+
+    ebr_enter();
+    LfNode* current = node_of(atomic_load(&list->head));
+    while (current != NULL) {
+        uintptr_t next = atomic_load(&current->next);
+        if (!is_marked(next)) {
+            count++;
+        }
+        current = node_of(next);
+    }
+    ebr_exit();
+
+    return count;
+}
+
+// Får bara anropas när inga andra trådar använder listan
+void lf_list_cleanup(LfList* list) {
+    LfNode* current = node_of(atomic_load(&list->head));
+    while (current != NULL) {
+        LfNode* next_node = node_of(atomic_load(&current->next));
+        mem_free(current);
+        current = next_node;
+    }
+    atomic_store(&list->head, 0);
+
+    ebr_drain();   // Frigör noder som väntar på en grace period
+    mem_deinit();  // Avslutar minneshanteraren
+}
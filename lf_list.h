@@ -0,0 +1,29 @@
+#ifndef LF_LIST_H
+#define LF_LIST_H
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint16_t, uintptr_t
+#include <stdatomic.h>
+
+// Lock-free sorted set of uint16_t values (Harris/Michael algorithm).
+// The lowest bit of a next pointer marks the node that owns it as deleted.
+// Any number of threads may insert, delete and search concurrently; unlinked
+// nodes are reclaimed through epoch.h once no reader can still reach them.
+
+typedef struct LfNode {
+    uint16_t data;
+    _Atomic uintptr_t next;
+} LfNode;
+
+typedef struct LfList {
+    _Atomic uintptr_t head;
+} LfList;
+
+// Function prototypes
+void lf_list_init(LfList* list, size_t size);
+int lf_list_insert(LfList* list, uint16_t data);
+int lf_list_delete(LfList* list, uint16_t data);
+int lf_list_contains(LfList* list, uint16_t data);
+size_t lf_list_count_nodes(LfList* list);
+void lf_list_cleanup(LfList* list);
+
+#endif  // LF_LIST_H
@@ -1,20 +1,46 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "memory_manager.h"
+#include "linked_list.h"  // Node-strukturen och funktionsprototyperna
+#include "list_format.h"
 
-// Define a structure named Node that we can use during the implementation:
-typedef struct Node {
-    uint16_t data;       // Stores the data as an unsigned 16_bit integer
-    struct Node* next;    //. A pointer to the next node in the list
-} Node;
 
+// Räknas upp av varje funktion som frigör eller flyttar om noder. En ListCompactor
+// jämför den med sitt sparade värde för att veta om den sparade länken går att lita på.
+static unsigned long list_generation = 0;
 
 // The function sets up the list and prepares it for operations
 void list_init(Node** head, size_t size) {
     *head = NULL;
+    list_generation++;
     mem_init(size);
 }
 
+// Som list_init, men poolen växer när den blir full, upp till max_size byte.
+// Befintliga noder flyttas aldrig.
+void list_init_growable(Node** head, size_t size, size_t max_size) {
+    *head = NULL;
+    list_generation++;
+    mem_init_growable(size, max_size);
+}
+
+// Gör plats för 'count' noder i förväg så att insättningarna inte behöver vänta på tillväxt
+int list_reserve(Node** head, size_t count) {
+    (void) head;
+    if (count > SIZE_MAX / sizeof(Node)) {
+        return -1;
+    }
+    return mem_reserve(count * sizeof(Node));
+}
+
 // Funktion för att infoga en ny nod i listan
 void list_insert(Node** head, uint16_t data) {
     // Skapar en ny nod och allokerar minne för den med hjälp av den anpassade minneshanteraren
@@ -22,7 +48,7 @@ void list_insert(Node** head, uint16_t data) {
     
     // Kontrollera om minnesallokeringen lyckades
     if (!new_node) {
-        printf("Minnesallokering misslyckades\n");  // Om allokeringen misslyckas, skriv ut felmeddelande
+        mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);  // Om allokeringen misslyckas, rapportera felet
         return;  // Avslutar funktionen:
     }
     
@@ -45,12 +71,51 @@ void list_insert(Node** head, uint16_t data) {
     }
 }
 
+// Infogar n värden sist i listan. Alla noder allokeras i en enda sammanhängande körning
+// och länkas i ordning, så att de ligger fysiskt efter varandra i minnet.
+void list_insert_array(Node** head, const uint16_t* values, size_t n) {
+    if (n == 0) {
+        return;  // Inget att infoga
+    }
+
+    // Allokera alla noder på en gång med den anpassade minneshanteraren
+    Node* nodes = (Node*) mem_alloc_contiguous(sizeof(Node), n);
+    if (!nodes) {
+        mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);  // Om allokeringen misslyckas, rapportera felet
+        return;
+    }
+
+    // Fyll i datan och länka varje nod till den fysiskt nästa noden
+    for (size_t i = 0; i < n - 1; i++) {
+        nodes[i].data = values[i];
+        nodes[i].next = &nodes[i + 1];
+    }
+    nodes[n - 1].data = values[n - 1];
+    nodes[n - 1].next = NULL;
+
+    // Koppla in körningen efter den sista noden, en enda genomgång av listan
+    if (*head == NULL) {
+        *head = nodes;
+    } else {
+        Node* current = *head;
+        while (current->next != NULL) {
+            current = current->next;
+        }
+        current->next = nodes;
+    }
+}
+
+// Skapar en ny lista med en minnespool som rymmer exakt n noder och fyller den med värdena
+void list_from_array(Node** head, const uint16_t* values, size_t n) {
+    list_init(head, (n > 0 ? n : 1) * sizeof(Node));
+    list_insert_array(head, values, n);
+}
 
 // - Skriver ut ett felmeddelande om minnesallokeringen misslyckas.
 void list_insert_after(Node* prev_node, uint16_t data) {
     // Kontrollera om föregående nod är NULL
     if (prev_node == NULL) {
-        printf("Den föregående noden får inte vara NULL\n");  // Felmeddelande om prev_node är NULL
+        mem_report(MEM_ERR_NULL_NODE, NULL);  // Rapportera fel om prev_node är NULL
         return;  // Avslutar funktionen eftersom det är ett ogiltigt tillstånd
     }
 
@@ -58,7 +123,7 @@ void list_insert_after(Node* prev_node, uint16_t data) {
     Node* new_node = (Node*) mem_alloc(sizeof(Node));
     // Kontrollera om minnesallokeringen lyckades
     if (!new_node) {
-        printf("Minnesallokering misslyckades\n");  // Felmeddelande om minnesallokeringen misslyckades
+        mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);  // Rapportera fel om minnesallokeringen misslyckades
         return;  // Avslutar funktionen
     }
 
@@ -76,7 +141,7 @@ void list_insert_after(Node* prev_node, uint16_t data) {
 void list_insert_before(Node** head, Node* next_node, uint16_t data) {
     // Kontrollera om next_node är NULL
     if (next_node == NULL) {
-        printf("Next node får inte vara NULL\n");  // Felmeddelande om next_node är NULL
+        mem_report(MEM_ERR_NULL_NODE, NULL);  // Rapportera fel om next_node är NULL
         return;  // Avslutar funktionen
     }
 
@@ -84,7 +149,7 @@ void list_insert_before(Node** head, Node* next_node, uint16_t data) {
     Node* new_node = (Node*) mem_alloc(sizeof(Node));
     // Kontrollera om minnesallokeringen lyckades
     if (!new_node) {
-        printf("Minnesallokering misslyckades\n");  // Felmeddelande om minnesallokeringen misslyckades
+        mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);  // Rapportera fel om minnesallokeringen misslyckades
         return;  // Avslutar funktionen
     }
     // Tilldela värdet till den nya nodens datafält
@@ -105,7 +170,7 @@ void list_insert_before(Node** head, Node* next_node, uint16_t data) {
 
     // Om next_node inte hittas i listan
     if (current == NULL) {
-        printf("Den angivna nästa noden finns inte i listan\n");  // Felmeddelande om next_node inte hittades
+        mem_report(MEM_ERR_NODE_NOT_IN_LIST, next_node);  // Rapportera fel om next_node inte hittades
         mem_free(new_node);  // Frigör minnet som tilldelades för den nya noden
         return;  // Avslutar funktionen
     }
@@ -118,7 +183,7 @@ void list_insert_before(Node** head, Node* next_node, uint16_t data) {
 
 void list_delete(Node** head, uint16_t data) {
     if (*head == NULL) {
-        printf("Listan är tom\n");  // Felmeddelande om listan är tom
+        mem_report(MEM_ERR_LIST_EMPTY, NULL);  // Rapportera fel om listan är tom
         return;
     }
 
@@ -132,7 +197,7 @@ void list_delete(Node** head, uint16_t data) {
     }
 
     if (current == NULL) {
-        printf("Data hittades inte i listan\n");  // Felmeddelande om datan inte hittas
+        mem_report(MEM_ERR_DATA_NOT_FOUND, NULL);  // Rapportera fel om datan inte hittas
         return;
     }
 
@@ -144,8 +209,186 @@ void list_delete(Node** head, uint16_t data) {
     }
 
     mem_free(current);  // Frigör minnet för den borttagna noden
+    list_generation++;
+}
+
+
+// Noder som ska frigöras samlas här och lämnas till minneshanteraren i ett enda anrop
+typedef struct {
+    void** items;
+    size_t count;
+    size_t capacity;
+    void* inline_items[256];  // Räcker för små borttagningar utan någon heap-allokering
+} FreeBatch;
+
+static void batch_init(FreeBatch* batch) {
+    batch->items = batch->inline_items;
+    batch->count = 0;
+    batch->capacity = sizeof(batch->inline_items) / sizeof(batch->inline_items[0]);
+}
+
+static void batch_flush(FreeBatch* batch) {
+    mem_free_batch(batch->items, batch->count);
+    batch->count = 0;
+}
+
+static void batch_add(FreeBatch* batch, Node* node) {
+    if (batch->count == batch->capacity) {
+        // Väx bufferten; går det inte, töm den i förtid i stället
+        size_t capacity = batch->capacity * 2;
+        void** items = (batch->items == batch->inline_items)
+                           ? (void**) malloc(capacity * sizeof(void*))
+                           : (void**) realloc(batch->items, capacity * sizeof(void*));
+        if (items) {
+            if (batch->items == batch->inline_items) {
+                memcpy(items, batch->inline_items, sizeof(batch->inline_items));
+            }
+            batch->items = items;
+            batch->capacity = capacity;
+        } else {
+            batch_flush(batch);
+        }
+    }
+    batch->items[batch->count++] = node;
+}
+
+static void batch_finish(FreeBatch* batch) {
+    batch_flush(batch);
+    if (batch->items != batch->inline_items) {
+        free(batch->items);
+    }
+}
+
+// Länkar ur alla noder där predikatets svar skiljer sig från 'keep' i en enda genomgång
+static size_t unlink_where(Node** head, ListPredicate predicate, void* ctx, int keep) {
+    FreeBatch batch;
+    batch_init(&batch);
+    size_t removed = 0;  // Egen räknare, batchen kan ha tömts på vägen
+
+    Node** link = head;  // Länken som pekar på den aktuella noden
+    while (*link != NULL) {
+        Node* current = *link;
+        if ((predicate(current->data, ctx) != 0) != keep) {
+            *link = current->next;  // Hoppa över noden
+            batch_add(&batch, current);
+            removed++;
+        } else {
+            link = &current->next;
+        }
+    }
+
+    batch_finish(&batch);
+    if (removed > 0) {
+        list_generation++;
+    }
+    return removed;
+}
+
+size_t list_remove_if(Node** head, ListPredicate predicate, void* ctx) {
+    return unlink_where(head, predicate, ctx, 0);
+}
+
+size_t list_retain_if(Node** head, ListPredicate predicate, void* ctx) {
+    return unlink_where(head, predicate, ctx, 1);
+}
+
+static int equals_value(uint16_t data, void* ctx) {
+    return data == *(const uint16_t*) ctx;
+}
+
+size_t list_delete_all(Node** head, uint16_t data) {
+    return unlink_where(head, equals_value, &data, 0);
+}
+
+// Slår ihop två sorterade kedjor till en. Stabil: vid lika värden kommer noden från 'a' först.
+static Node* merge_runs(Node* a, Node* b) {
+    Node* result = NULL;
+    Node** tail = &result;  // Länken där nästa nod ska hängas på
+
+    while (a != NULL && b != NULL) {
+        if (b->data < a->data) {
+            *tail = b;
+            b = b->next;
+        } else {
+            *tail = a;
+            a = a->next;
+        }
+        tail = &(*tail)->next;
+    }
+    *tail = (a != NULL) ? a : b;  // Resten är redan sorterad
+    return result;
+}
+
+// Icke-rekursiv bottom-up merge sort direkt på nodernas länkar, utan extra allokering.
+// pending[i] håller en sorterad kedja med 2^i noder, som bitarna i en binär räknare.
+void list_sort(Node** head) {
+    Node* pending[64] = { NULL };
+    int levels = 0;
+
+    Node* current = *head;
+    while (current != NULL) {
+        Node* run = current;
+        current = current->next;
+        run->next = NULL;
+
+        // Slå ihop med lika stora kedjor så länge det finns en "carry"
+        int i = 0;
+        while (i < levels && pending[i] != NULL) {
+            run = merge_runs(pending[i], run);  // Äldre kedja först bevarar stabiliteten
+            pending[i] = NULL;
+            i++;
+        }
+        pending[i] = run;
+        if (i == levels) {
+            levels++;
+        }
+    }
+
+    // Slå ihop de kvarvarande kedjorna, högre nivåer innehåller tidigare noder
+    Node* result = NULL;
+    for (int i = 0; i < levels; i++) {
+        if (pending[i] != NULL) {
+            result = (result != NULL) ? merge_runs(pending[i], result) : pending[i];
+        }
+    }
+    *head = result;
+    list_generation++;
+}
+
+int list_is_sorted(Node** head) {
+    Node* current = *head;
+    while (current != NULL && current->next != NULL) {
+        if (current->next->data < current->data) {
+            return 0;
+        }
+        current = current->next;
+    }
+    return 1;
+}
+
+// Infogar värdet efter alla noder med mindre eller lika data, så listan förblir sorterad
+void list_insert_sorted(Node** head, uint16_t data) {
+    Node* new_node = (Node*) mem_alloc(sizeof(Node));
+    if (!new_node) {
+        mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);
+        return;
+    }
+    new_node->data = data;
+
+    Node** link = head;
+    while (*link != NULL && (*link)->data <= data) {
+        link = &(*link)->next;
+    }
+    new_node->next = *link;
+    *link = new_node;
 }
 
+// Slår ihop två sorterade listor i samma pool. Alla noder hamnar i *head och *other blir tom.
+void list_merge(Node** head, Node** other) {
+    *head = merge_runs(*head, *other);
+    *other = NULL;
+    list_generation++;
+}
 
 Node* list_search(Node** head, uint16_t data) {
     Node* current = *head;  // Pekare till den aktuella noden
@@ -158,31 +401,365 @@ Node* list_search(Node** head, uint16_t data) {
     return NULL;  // Returnerar NULL om datan inte hittas
 }
 
+// Formaterar noderna från start till och med end (eller listans slut) som "[a, b, c]".
+// Texten byggs i buf och lämnas till mottagaren i block om högst cap tecken.
+static int list_render(Node* start, Node* end, char* buf, size_t cap, ListSink sink, void* ctx) {
+    size_t used = 0;
+    Node* current = start;
+
+    buf[used++] = '[';
+    while (current != NULL && (end == NULL || current != end->next)) {
+        // Töm bufferten om nästa element inte garanterat får plats
+        if (cap - used < LIST_MAX_ELEMENT_TEXT + 1) {
+            if (sink(ctx, buf, used) != 0) {
+                return -1;
+            }
+            used = 0;
+        }
+        used += list_u16_to_ascii(current->data, buf + used);
+        if (current->next != NULL && current != end) {
+            buf[used++] = ',';  // Komma om det finns fler noder
+            buf[used++] = ' ';
+        }
+        current = current->next;
+    }
+    buf[used++] = ']';
+
+    return sink(ctx, buf, used);
+}
+
+// Mottagare som kopierar texten till en användarbuffert, som snprintf
+typedef struct {
+    char* out;
+    size_t cap;
+    size_t len;  // Total längd, även den del som inte fick plats
+} FormatSink;
+
+static int format_sink(void* ctx, const char* data, size_t len) {
+    FormatSink* f = (FormatSink*) ctx;
+    if (f->len + 1 < f->cap) {
+        size_t room = f->cap - 1 - f->len;
+        memcpy(f->out + f->len, data, len < room ? len : room);
+    }
+    f->len += len;
+    return 0;
+}
+
+// Mottagare som skriver direkt till en filbeskrivare, hanterar avbrutna och ofullständiga skrivningar
+int list_fd_sink(void* ctx, const char* data, size_t len) {
+    int fd = *(int*) ctx;
+    while (len > 0) {
+        ssize_t written = write(fd, data, len);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += written;
+        len -= (size_t) written;
+    }
+    return 0;
+}
+
+size_t list_format(Node** head, char* buf, size_t cap) {
+    char stage[256];  // Liten mellanbuffert på stacken, ingen heap-allokering
+    FormatSink f = { buf, cap, 0 };
+
+    list_render(*head, NULL, stage, sizeof(stage), format_sink, &f);
+    if (cap > 0) {
+        buf[f.len < cap ? f.len : cap - 1] = '\0';
+    }
+    return f.len;  // Som snprintf: längden som hade behövts
+}
+
+int list_write_range(Node** head, Node* start_node, Node* end_node, int fd) {
+    char buf[LIST_WRITE_BUFFER];
+    Node* start = start_node ? start_node : *head;  // Starta från start_node eller huvudnoden
+    return list_render(start, end_node, buf, sizeof(buf), list_fd_sink, &fd);
+}
+
+int list_write(Node** head, int fd) {
+    return list_write_range(head, NULL, NULL, fd);
+}
+
 void list_display(Node** head) {
-    Node* current = *head;  // Pekare till den aktuella noden
-    printf("[");
+    fflush(stdout);  // Bevara ordningen mot text som redan ligger i stdio-bufferten
+    list_write(head, fileno(stdout));
+}
+
+void list_display_range(Node** head, Node* start_node, Node* end_node) {
+    fflush(stdout);
+    list_write_range(head, start_node, end_node, fileno(stdout));
+}
+
+// Binärt ögonblicksformat: ett huvud följt av alla värden som en packad uint16_t-array
+#define LIST_SNAPSHOT_MAGIC "LLSNAP\0\0"
+#define LIST_SNAPSHOT_BYTE_ORDER 0x01020304u
+
+typedef struct {
+    char magic[8];        // Identifierar filtypen
+    uint32_t version;     // LIST_SNAPSHOT_VERSION
+    uint32_t byte_order;  // Skrivs i maskinens byteordning, avslöjar filer från andra arkitekturer
+    uint64_t count;       // Antal värden efter huvudet
+} ListSnapshotHeader;
+
+// Synka katalogen så att själva namnbytet överlever ett strömavbrott
+static int sync_parent_dir(const char* path) {
+    char dir[4096];
+    const char* slash = strrchr(path, '/');
+    if (slash == NULL) {
+        strcpy(dir, ".");
+    } else if (slash == path) {
+        strcpy(dir, "/");
+    } else {
+        size_t len = slash - path;
+        if (len >= sizeof(dir)) {
+            return -1;
+        }
+        memcpy(dir, path, len);
+        dir[len] = '\0';
+    }
+
+    int fd = open(dir, O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return -1;
+    }
+    int status = fsync(fd) == 0 ? 0 : -1;
+    close(fd);
+    return status;
+}
+
+int list_save(Node** head, const char* path) {
+    char tmp_path[4096];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int) sizeof(tmp_path)) {
+        return -1;  // Sökvägen är för lång
+    }
+
+    // Skriv till en temporär fil och byt namn till sist, så att en gammal ögonblicksbild aldrig blir halvskriven
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    ListSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LIST_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = LIST_SNAPSHOT_VERSION;
+    header.byte_order = LIST_SNAPSHOT_BYTE_ORDER;
+
+    // Platshållare för huvudet, antalet är känt först när listan har strömmats ut
+    int status = list_fd_sink(&fd, (const char*) &header, sizeof(header));
+
+    uint16_t buf[LIST_WRITE_BUFFER / sizeof(uint16_t)];
+    size_t used = 0;
+    Node* current = *head;
+    while (status == 0 && current != NULL) {
+        buf[used++] = current->data;
+        header.count++;
+        if (used == sizeof(buf) / sizeof(buf[0])) {
+            status = list_fd_sink(&fd, (const char*) buf, sizeof(buf));
+            used = 0;
+        }
+        current = current->next;
+    }
+    if (status == 0 && used > 0) {
+        status = list_fd_sink(&fd, (const char*) buf, used * sizeof(uint16_t));
+    }
+
+    // Skriv det slutliga huvudet med rätt antal
+    if (status == 0 && pwrite(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header)) {
+        status = -1;
+    }
+    // Innehållet måste nå disken före namnbytet, annars kan ett strömavbrott lämna en tom fil
+    if (status == 0 && fsync(fd) != 0) {
+        status = -1;
+    }
+    if (close(fd) != 0) {
+        status = -1;
+    }
+    if (status == 0 && rename(tmp_path, path) != 0) {
+        status = -1;
+    }
+    if (status != 0) {
+        unlink(tmp_path);
+        return status;
+    }
+    return sync_parent_dir(path);
+}
+
+int list_load(Node** head, const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(ListSnapshotHeader)) {
+        close(fd);
+        return -1;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // Mappningen lever vidare utan filbeskrivaren
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    // Kontrollera huvudet innan listan byggs
+    const ListSnapshotHeader* header = (const ListSnapshotHeader*) map;
+    size_t payload = (size_t) st.st_size - sizeof(ListSnapshotHeader);
+    if (memcmp(header->magic, LIST_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != LIST_SNAPSHOT_VERSION ||
+        header->byte_order != LIST_SNAPSHOT_BYTE_ORDER ||
+        header->count != payload / sizeof(uint16_t) ||
+        payload % sizeof(uint16_t) != 0) {
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    // Bygg hela listan med en enda allokering direkt från den mappade arrayen
+    const uint16_t* values = (const uint16_t*) (header + 1);
+    size_t count = (size_t) header->count;
+    list_from_array(head, values, count);
+
+    munmap(map, st.st_size);
+    return (count > 0 && *head == NULL) ? -1 : 0;
+}
+
+// Kopierar högst cap värden i listordning till out, returnerar antalet kopierade
+size_t list_to_array(Node** head, uint16_t* out, size_t cap) {
+    ListIter it = list_iter_begin(head);
+    return list_iter_next_batch(&it, out, cap);
+}
+
+// Som list_to_array men från start_node till och med end_node, NULL som slut betyder listans slut
+size_t list_range_to_array(Node* start_node, Node* end_node, uint16_t* out, size_t cap) {
+    size_t count = 0;
+    for (Node* current = start_node; current != NULL && count < cap; current = current->next) {
+        out[count++] = current->data;
+        if (current == end_node) {
+            break;
+        }
+    }
+    return count;
+}
+
+// Anropar fn för varje nod från start_node till och med end_node, returnerar antalet besökta noder
+size_t list_for_each_range(Node* start_node, Node* end_node, ListVisitFn fn, void* ctx) {
+    size_t count = 0;
+    Node* current = start_node;
     while (current != NULL) {
-        printf("%u", current->data);  // Skriv ut datan för den aktuella noden
+        Node* next = current->next;  // fn får ändra noden
+        fn(current, ctx);
+        count++;
+        if (current == end_node) {
+            break;
+        }
+        current = next;
+    }
+    return count;
+}
+
+// Andel länkar där nästa nod inte ligger direkt efter den aktuella i minnet.
+// 0 betyder att listan ligger helt i ordning, nära 1 att varje steg är ett hopp.
+double list_disorder(Node** head) {
+    size_t links = 0;
+    size_t jumps = 0;
+    LIST_FOREACH(current, head) {
         if (current->next != NULL) {
-            printf(", ");  // Skriv ut komma om det finns fler noder
+            links++;
+            jumps += (current->next != current + 1);
         }
-        current = current->next;
     }
-    printf("]");
+    return links ? (double) jumps / (double) links : 0.0;
 }
 
-void list_display_range(Node** head, Node* start_node, Node* end_node) {
-    Node* current = start_node ? start_node : *head;  // Starta från start_node eller huvudnoden
+void list_compact_begin(ListCompactor* compactor, Node** head) {
+    compactor->head = head;
+    compactor->done = 0;
+    compactor->link = head;
+    compactor->prev = NULL;
+    compactor->generation = list_generation;
+}
 
-    printf("[");
-    while (current != NULL && (end_node == NULL || current != end_node->next)) {
-        printf("%d", current->data);  // Skriv ut datan för den aktuella noden
-        if (current->next != NULL && current != end_node) {
-            printf(", ");  // Skriv ut komma om det finns fler noder
+// Flyttar högst max_nodes noder till en ny sammanhängande körning i listordning.
+// Returnerar antalet noder som gåtts igenom, 0 när listan är klar eller poolen är full.
+size_t list_compact_step(ListCompactor* compactor, size_t max_nodes) {
+    size_t processed = 0;
+    Node** link = compactor->link;
+    Node* prev = compactor->prev;
+
+    // Har noder frigjorts eller flyttats om sedan förra steget kan den sparade länken
+    // peka in i frigjort minne. Leta då upp positionen från huvudet igen; noderna
+    // före den ligger redan i följd, så genomgången går i minnesordning.
+    if (compactor->generation != list_generation) {
+        link = compactor->head;
+        prev = NULL;
+        for (size_t i = 0; i < compactor->done && *link != NULL; i++) {
+            prev = *link;
+            link = &prev->next;
         }
-        current = current->next;  // Gå till nästa nod
     }
-    printf("]");
+
+    // Hoppa över noder som redan ligger rätt: direkt efter föregående nod eller först i en ordnad följd
+    while (*link != NULL && processed < max_nodes) {
+        Node* node = *link;
+        if ((prev == NULL || node != prev + 1) && node->next != node + 1) {
+            break;
+        }
+        prev = node;
+        link = &node->next;
+        processed++;
+    }
+
+    // Räkna hur många noder som ska flyttas i detta steg
+    size_t count = 0;
+    for (Node* current = *link; current != NULL && processed + count < max_nodes; current = current->next) {
+        count++;
+    }
+
+    // Ta så stor sammanhängande körning som poolen kan ge
+    Node* run = NULL;
+    while (count > 0 && (run = (Node*) mem_alloc_contiguous(sizeof(Node), count)) == NULL) {
+        count /= 2;
+    }
+
+    if (run != NULL) {
+        FreeBatch batch;
+        batch_init(&batch);
+
+        Node* old = *link;
+        for (size_t i = 0; i < count; i++) {
+            Node* next_old = old->next;
+            run[i].data = old->data;
+            run[i].next = (i + 1 < count) ? &run[i + 1] : next_old;
+            batch_add(&batch, old);
+            old = next_old;
+        }
+        *link = run;
+        processed += count;
+        prev = &run[count - 1];
+        link = &prev->next;
+
+        batch_finish(&batch);  // De gamla noderna lämnas tillbaka i ett anrop
+        list_generation++;  // Andra kompaktorer kan ha sparat länkar i de gamla noderna
+    }
+
+    compactor->done += processed;
+    compactor->link = link;
+    compactor->prev = prev;
+    compactor->generation = list_generation;
+    return processed;
+}
+
+void list_compact(Node** head) {
+    ListCompactor compactor;
+    list_compact_begin(&compactor, head);
+    while (list_compact_step(&compactor, SIZE_MAX) > 0) {
+        // Körs tills listan är klar eller ingen mer plats finns
+    }
 }
 
 int list_count_nodes(Node** head) {
@@ -195,13 +772,9 @@ int list_count_nodes(Node** head) {
     return count;  // Returnerar det totala antalet noder
 }
 
+// Noderna frigörs inte en och en, mem_deinit lämnar tillbaka hela poolen på en gång
 void list_cleanup(Node** head) {
-    Node* current = *head;  // Pekare till den aktuella noden
-    while (current != NULL) {
-        Node* next_node = current->next;  // Pekare till nästa nod
-        mem_free(current);  // Frigör minnet för den aktuella noden
-        current = next_node;  // Gå till nästa nod
-    }
     *head = NULL;  // Sätter huvudpekaren till NULL för att markera listan som tom
+    list_generation++;
     mem_deinit();  // Avslutar minneshanteraren
 }
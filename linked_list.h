@@ -4,21 +4,127 @@
 
 #include <stdint.h>  // For uint16_t
 
+// Version of the binary format written by list_save
+#define LIST_SNAPSHOT_VERSION 1
+
 typedef struct Node {
     uint16_t data;
     struct Node* next;
 } Node;
 
+// Progress of an incremental list_compact: the first 'done' nodes are in place.
+// A step resumes at the saved link, so it costs O(max_nodes) however far the
+// compaction has come. The list may be changed between steps through the
+// list_* functions. Inserts keep the saved link valid; after a delete, sort,
+// merge or another compactor's step the next step finds its position again
+// by walking 'done' nodes from *head. Nodes inserted or deleted in front of
+// the position shift it; those nodes are then skipped or checked once more.
+// Relinking or freeing nodes by hand requires list_compact_begin again.
+// Relocated nodes get new addresses, so Node pointers into the list go stale.
+typedef struct ListCompactor {
+    Node** head;
+    size_t done;
+    Node** link;               // Link to the first node not yet in place
+    Node* prev;                // Node owning 'link', NULL when link is head
+    unsigned long generation;  // List changes seen when 'link' was saved
+} ListCompactor;
+
+// Returns non-zero for values that match
+typedef int (*ListPredicate)(uint16_t data, void* ctx);
+// Called once per visited node
+typedef void (*ListVisitFn)(Node* node, void* ctx);
+
 // Function prototypes
 void list_init(Node** head, size_t size);
+void list_init_growable(Node** head, size_t size, size_t max_size);
+int list_reserve(Node** head, size_t count);
 void list_insert(Node** head, uint16_t data);
+void list_insert_array(Node** head, const uint16_t* values, size_t n);
+void list_from_array(Node** head, const uint16_t* values, size_t n);
 void list_insert_after(Node* prev_node, uint16_t data);
 void list_insert_before(Node** head, Node* next_node, uint16_t data);
 void list_delete(Node** head, uint16_t data);
+size_t list_delete_all(Node** head, uint16_t data);
+size_t list_remove_if(Node** head, ListPredicate predicate, void* ctx);
+size_t list_retain_if(Node** head, ListPredicate predicate, void* ctx);
 Node* list_search(Node** head, uint16_t data);
+void list_sort(Node** head);
+int list_is_sorted(Node** head);
+void list_insert_sorted(Node** head, uint16_t data);
+void list_merge(Node** head, Node** other);
 void list_display(Node** head);
 void list_display_range(Node** head, Node* start_node, Node* end_node);
+size_t list_format(Node** head, char* buf, size_t cap);
+int list_write(Node** head, int fd);
+int list_write_range(Node** head, Node* start_node, Node* end_node, int fd);
+int list_save(Node** head, const char* path);
+int list_load(Node** head, const char* path);
 int list_count_nodes(Node** head);
+size_t list_to_array(Node** head, uint16_t* out, size_t cap);
+size_t list_range_to_array(Node* start_node, Node* end_node, uint16_t* out, size_t cap);
+size_t list_for_each_range(Node* start_node, Node* end_node, ListVisitFn fn, void* ctx);
+double list_disorder(Node** head);
+void list_compact(Node** head);
+void list_compact_begin(ListCompactor* compactor, Node** head);
+size_t list_compact_step(ListCompactor* compactor, size_t max_nodes);
 void list_cleanup(Node** head);
 
+// ********* Iterators *********
+// A cursor over the list that prefetches LIST_PREFETCH_DISTANCE nodes ahead
+// of the node it returns. The current node may be modified or freed after it
+// has been returned, but nodes further ahead must not be unlinked.
+// The lookahead pointer is itself found by following next, so the walk is
+// still one dependent load per node. The prefetch only pays off when the
+// caller does substantial work per node; a bare walk gains nothing from it.
+
+#define LIST_PREFETCH_DISTANCE 8
+
+typedef struct ListIter {
+    Node* current;  // Next node to return
+    Node* ahead;    // Node LIST_PREFETCH_DISTANCE steps further, already prefetched
+    int active;     // Used by LIST_FOREACH to stop after a break
+} ListIter;
+
+static inline ListIter list_iter_begin(Node** head) {
+    ListIter it = { *head, *head, 1 };
+    for (int i = 0; i < LIST_PREFETCH_DISTANCE && it.ahead != NULL; i++) {
+        it.ahead = it.ahead->next;
+        if (it.ahead != NULL) {
+            __builtin_prefetch(it.ahead, 0, 1);
+        }
+    }
+    return it;
+}
+
+static inline Node* list_iter_next(ListIter* it) {
+    Node* node = it->current;
+    if (node != NULL) {
+        it->current = node->next;
+        if (it->ahead != NULL) {
+            it->ahead = it->ahead->next;
+            if (it->ahead != NULL) {
+                __builtin_prefetch(it->ahead, 0, 1);
+            }
+        }
+    }
+    return node;
+}
+
+// Copies up to max values into out and returns how many were copied, 0 at the end
+static inline size_t list_iter_next_batch(ListIter* it, uint16_t* out, size_t max) {
+    size_t count = 0;
+    Node* node;
+    while (count < max && (node = list_iter_next(it)) != NULL) {
+        out[count++] = node->data;
+    }
+    return count;
+}
+
+// Iterates over every node: LIST_FOREACH(node, &head) { ... node->data ... }
+#define LIST_FOREACH(node, head)                                                    \
+    for (ListIter node##_iter = list_iter_begin(head); node##_iter.active;          \
+         node##_iter.active = 0)                                                    \
+        for (Node* node = list_iter_next(&node##_iter); node != NULL;               \
+             node = list_iter_next(&node##_iter))
+
 #endif  // LINKED_LIST_H
@@ -0,0 +1,61 @@
+#ifndef LIST_FORMAT_H
+#define LIST_FORMAT_H
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint16_t
+#include <string.h>  // For memcpy
+
+// Internal helpers shared by the list variants that render themselves as
+// text "[a, b, c]": values are converted without printf and staged in a
+// large buffer, which a sink receives in a few big pieces.
+
+// Staging buffer size: large pieces mean few system calls
+#define LIST_WRITE_BUFFER 65536
+
+// Longest text one element can produce: five digits plus ", "
+#define LIST_MAX_ELEMENT_TEXT 7
+
+// Receives formatted text, returns 0 on success
+typedef int (*ListSink)(void* ctx, const char* data, size_t len);
+
+// Writes everything to the file descriptor *(int*) ctx, retrying after
+// interrupted and partial writes (linked_list.c).
+int list_fd_sink(void* ctx, const char* data, size_t len);
+
+static const char list_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Writes the decimal text of value, two digits at a time from the back,
+// and returns the number of characters.
+static inline size_t list_u16_to_ascii(uint16_t value, char* out) {
+    char tmp[5];
+    char* p = tmp + sizeof(tmp);
+    unsigned v = value;
+
+    while (v >= 100) {
+        unsigned pair = (v % 100) * 2;
+        v /= 100;
+        *--p = list_digit_pairs[pair + 1];
+        *--p = list_digit_pairs[pair];
+    }
+    if (v >= 10) {
+        *--p = list_digit_pairs[v * 2 + 1];
+        *--p = list_digit_pairs[v * 2];
+    } else {
+        *--p = (char)('0' + v);
+    }
+
+    size_t len = tmp + sizeof(tmp) - p;
+    memcpy(out, p, len);
+    return len;
+}
+
+#endif  // LIST_FORMAT_H
@@ -0,0 +1,304 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "list_parallel.h"
+
+// Ett jobb delas i segment som trådarna plockar ett i taget tills alla är klara
+typedef struct {
+    void (*run)(void* job, const ListIndex* index, size_t segment);
+    void* arg;
+    const ListIndex* index;
+    atomic_size_t next_segment;
+    atomic_size_t finished;
+    int active_workers;  // Skyddas av pool_mutex, jobbet får inte försvinna medan det är > 0
+} ParallelJob;
+
+// Trådpoolen skapas vid första användningen och lever tills list_parallel_shutdown
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t submit_mutex = PTHREAD_MUTEX_INITIALIZER;  // Ett jobb åt gången
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t* workers = NULL;
+static int worker_count = 0;
+static int requested_threads = 0;  // 0 betyder en tråd per kärna
+static ParallelJob* current_job = NULL;
+static unsigned long job_generation = 0;
+static int shutting_down = 0;
+
+// Kör segment ur jobbet tills det inte finns fler, returnerar när detta anrop är klart
+static void work_on(ParallelJob* job) {
+    size_t total = job->index->count;
+    size_t segment;
+    while ((segment = atomic_fetch_add(&job->next_segment, 1)) < total) {
+        job->run(job->arg, job->index, segment);
+        if (atomic_fetch_add(&job->finished, 1) + 1 == total) {
+            pthread_mutex_lock(&pool_mutex);
+            pthread_cond_broadcast(&done_cond);
+            pthread_mutex_unlock(&pool_mutex);
+        }
+    }
+}
+
+static void* worker_main(void* arg) {
+    (void) arg;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool_mutex);
+    for (;;) {
+        while (!shutting_down && (current_job == NULL || job_generation == seen)) {
+            pthread_cond_wait(&work_cond, &pool_mutex);
+        }
+        if (shutting_down) {
+            break;
+        }
+        seen = job_generation;
+        ParallelJob* job = current_job;
+        job->active_workers++;
+        pthread_mutex_unlock(&pool_mutex);
+
+        work_on(job);
+
+        pthread_mutex_lock(&pool_mutex);
+        if (--job->active_workers == 0) {
+            pthread_cond_broadcast(&done_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool_mutex);
+    return NULL;
+}
+
+// Starta arbetstrådarna, anroparen deltar själv så poolen får en tråd mindre
+static void start_pool(void) {
+    int threads = requested_threads > 0 ? requested_threads : (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    workers = (pthread_t*) malloc(sizeof(pthread_t) * threads);
+    if (!workers) {
+        perror("Misslyckades med att skapa trådpoolen");
+        exit(EXIT_FAILURE);
+    }
+    shutting_down = 0;
+    worker_count = 0;
+    for (int i = 0; i < threads - 1; i++) {
+        if (pthread_create(&workers[worker_count], NULL, worker_main, NULL) == 0) {
+            worker_count++;
+        }
+    }
+}
+
+static void run_parallel(const ListIndex* index, void (*run)(void*, const ListIndex*, size_t), void* arg) {
+    if (index->count == 0) {
+        return;
+    }
+
+    ParallelJob job = { run, arg, index, 0, 0, 0 };
+
+    pthread_mutex_lock(&submit_mutex);
+    pthread_mutex_lock(&pool_mutex);
+    if (workers == NULL) {
+        start_pool();
+    }
+    current_job = &job;
+    job_generation++;
+    pthread_cond_broadcast(&work_cond);
+    pthread_mutex_unlock(&pool_mutex);
+
+    work_on(&job);
+
+    // Vänta tills alla segment är klara och ingen arbetstråd längre rör jobbet
+    pthread_mutex_lock(&pool_mutex);
+    while (atomic_load(&job.finished) < index->count || job.active_workers > 0) {
+        pthread_cond_wait(&done_cond, &pool_mutex);
+    }
+    current_job = NULL;
+    pthread_mutex_unlock(&pool_mutex);
+    pthread_mutex_unlock(&submit_mutex);
+}
+
+void list_parallel_shutdown(void) {
+    pthread_mutex_lock(&submit_mutex);
+    pthread_mutex_lock(&pool_mutex);
+    shutting_down = 1;
+    pthread_cond_broadcast(&work_cond);
+    pthread_mutex_unlock(&pool_mutex);
+
+    for (int i = 0; i < worker_count; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(workers);
+    workers = NULL;
+    worker_count = 0;
+    pthread_mutex_unlock(&submit_mutex);
+}
+
+// Antal trådar (inklusive anroparen) som används, 0 betyder en per kärna
+void list_parallel_set_threads(int threads) {
+    list_parallel_shutdown();
+    requested_threads = threads;
+}
+
+// Bygg expresspekarna med en genomgång av listan
+int list_index_build(ListIndex* index, Node** head, size_t stride) {
+    if (stride == 0) {
+        stride = LIST_INDEX_STRIDE;
+    }
+
+    size_t capacity = 64;
+    index->segments = (Node**) malloc(sizeof(Node*) * capacity);
+    index->count = 0;
+    index->stride = stride;
+    if (!index->segments) {
+        return -1;
+    }
+
+    size_t position = 0;
+    Node* current = *head;
+    while (current != NULL) {
+        if (position % stride == 0) {
+            if (index->count == capacity) {
+                capacity *= 2;
+                Node** grown = (Node**) realloc(index->segments, sizeof(Node*) * capacity);
+                if (!grown) {
+                    list_index_free(index);
+                    return -1;
+                }
+                index->segments = grown;
+            }
+            index->segments[index->count++] = current;
+        }
+        position++;
+        current = current->next;
+    }
+    return 0;
+}
+
+void list_index_free(ListIndex* index) {
+    free(index->segments);
+    index->segments = NULL;
+    index->count = 0;
+}
+
+// Slutet på ett segment är början på nästa
+static inline Node* segment_end(const ListIndex* index, size_t segment) {
+    return segment + 1 < index->count ? index->segments[segment + 1] : NULL;
+}
+
+// ---- Räkning ----
+
+static void count_segment(void* arg, const ListIndex* index, size_t segment) {
+    size_t* counts = (size_t*) arg;
+    Node* end = segment_end(index, segment);
+    size_t count = 0;
+    for (Node* current = index->segments[segment]; current != end; current = current->next) {
+        count++;
+    }
+    counts[segment] = count;
+}
+
+size_t list_count(const ListIndex* index) {
+    size_t* counts = (size_t*) calloc(index->count ? index->count : 1, sizeof(size_t));
+    if (!counts) {
+        return 0;
+    }
+    run_parallel(index, count_segment, counts);
+
+    size_t total = 0;
+    for (size_t i = 0; i < index->count; i++) {
+        total += counts[i];
+    }
+    free(counts);
+    return total;
+}
+
+// ---- Sökning ----
+
+typedef struct {
+    uint16_t data;
+    _Atomic(Node*) found;
+} SearchJob;
+
+static void search_segment(void* arg, const ListIndex* index, size_t segment) {
+    SearchJob* job = (SearchJob*) arg;
+    Node* end = segment_end(index, segment);
+    size_t steps = 0;
+
+    for (Node* current = index->segments[segment]; current != end; current = current->next) {
+        // Avbryt tidigt om en annan tråd redan har hittat värdet
+        if ((++steps & 1023) == 0 && atomic_load_explicit(&job->found, memory_order_relaxed) != NULL) {
+            return;
+        }
+        if (current->data == job->data) {
+            Node* expected = NULL;
+            atomic_compare_exchange_strong(&job->found, &expected, current);
+            return;
+        }
+    }
+}
+
+// Returnerar någon nod med värdet, inte nödvändigtvis den första i listan
+Node* list_search_any(const ListIndex* index, uint16_t data) {
+    SearchJob job = { data, NULL };
+    run_parallel(index, search_segment, &job);
+    return atomic_load(&job.found);
+}
+
+// ---- Reduktion ----
+
+typedef struct {
+    uint64_t identity;
+    ListReduceFn fn;
+    uint64_t* partial;
+} ReduceJob;
+
+static void reduce_segment(void* arg, const ListIndex* index, size_t segment) {
+    ReduceJob* job = (ReduceJob*) arg;
+    Node* end = segment_end(index, segment);
+    uint64_t acc = job->identity;
+    for (Node* current = index->segments[segment]; current != end; current = current->next) {
+        acc = job->fn(acc, current->data);
+    }
+    job->partial[segment] = acc;
+}
+
+uint64_t list_reduce(const ListIndex* index, uint64_t identity, ListReduceFn fn,
+                     ListCombineFn combine) {
+    ReduceJob job = { identity, fn, NULL };
+    job.partial = (uint64_t*) malloc(sizeof(uint64_t) * (index->count ? index->count : 1));
+    if (!job.partial) {
+        return identity;
+    }
+    run_parallel(index, reduce_segment, &job);
+
+    // Segmentens delresultat kombineras i listordning
+    uint64_t acc = identity;
+    for (size_t i = 0; i < index->count; i++) {
+        acc = combine(acc, job.partial[i]);
+    }
+    free(job.partial);
+    return acc;
+}
+
+// ---- Besök varje nod ----
+
+typedef struct {
+    ListVisitFn fn;
+    void* ctx;
+} VisitJob;
+
+static void visit_segment(void* arg, const ListIndex* index, size_t segment) {
+    VisitJob* job = (VisitJob*) arg;
+    Node* end = segment_end(index, segment);
+    for (Node* current = index->segments[segment]; current != end; current = current->next) {
+        job->fn(current, job->ctx);
+    }
+}
+
+void list_for_each(const ListIndex* index, ListVisitFn fn, void* ctx) {
+    VisitJob job = { fn, ctx };
+    run_parallel(index, visit_segment, &job);
+}
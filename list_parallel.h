@@ -0,0 +1,44 @@
+#ifndef LIST_PARALLEL_H
+#define LIST_PARALLEL_H
+#include <stddef.h>  // For size_t
+
+#include <stdint.h>  // For uint16_t, uint64_t
+#include "linked_list.h"
+
+// Parallel traversal of long lists. A ListIndex keeps sparse "express"
+// pointers to every stride-th node, which cut the list into segments that a
+// thread pool can walk independently. The index describes the list as it was
+// when built and is not updated by inserts or deletes: rebuild it after any
+// structural change. A build is a serial walk of the whole list, so the
+// parallel operations only pay off when several of them run on one index.
+
+// Default distance between express pointers
+#define LIST_INDEX_STRIDE 4096
+
+typedef struct ListIndex {
+    Node** segments;  // First node of every segment
+    size_t count;     // Number of segments
+    size_t stride;    // Nodes per segment (the last one may be shorter)
+} ListIndex;
+
+// Folds one node's value into an accumulator
+typedef uint64_t (*ListReduceFn)(uint64_t acc, uint64_t value);
+// Combines the results of two segments, in list order; must be associative
+// with identity as its neutral element
+typedef uint64_t (*ListCombineFn)(uint64_t left, uint64_t right);
+
+// Function prototypes
+int list_index_build(ListIndex* index, Node** head, size_t stride);
+void list_index_free(ListIndex* index);
+size_t list_count(const ListIndex* index);
+Node* list_search_any(const ListIndex* index, uint16_t data);
+// Each segment is folded from identity with fn, then the segment results
+// are combined with combine. For a sum both are addition.
+uint64_t list_reduce(const ListIndex* index, uint64_t identity, ListReduceFn fn,
+                     ListCombineFn combine);
+// fn may be called from several threads at the same time
+void list_for_each(const ListIndex* index, ListVisitFn fn, void* ctx);
+void list_parallel_set_threads(int threads);
+void list_parallel_shutdown(void);
+
+#endif  // LIST_PARALLEL_H
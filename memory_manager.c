@@ -1,161 +1,809 @@
+#define _GNU_SOURCE  // mremap
 #include <stdio.h>
 #include <stdlib.h>
-#include <stdint.h>
 #include <string.h>
 #include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "mm_backend.h"
 
-typedef struct MemBlock {
-    size_t block_size;           
-    int is_available;            
-    struct MemBlock* next_block; 
-    void* data_ptr;              
-} MemBlock;
+// Minneshanteraren väljer allokeringsstrategi när poolen skapas och skickar sedan
+// varje anrop vidare till den. Strategin anges med mem_set_backend eller med
+// miljövariabeln MM_BACKEND, så samma binär kan köras mot alla strategier.
 
+static const MemBackend* const backends[] = {
+    &mm_firstfit_backend,
+    &mm_bestfit_backend,
+    &mm_buddy_backend,
+    &mm_tlsf_backend,
+};
 
-void* pool_start = NULL;       
-MemBlock* pool_head = NULL;    
-size_t total_pool_size = 0; 
+#define BACKEND_COUNT (sizeof(backends) / sizeof(backends[0]))
 
+// Strategin som nästa mem_init använder, NULL betyder MM_BACKEND eller first-fit
+static const MemBackend* selected = NULL;
+// Strategin som äger den nuvarande poolen
+static const MemBackend* active = &mm_firstfit_backend;
 
-void mem_init(size_t pool_size) {
-    // Allokera minne för hela minnespoolen
-    pool_start = malloc(pool_size);
-    if (!pool_start) {
-        perror("Misslyckades med att allokera minnespool");
-        exit(EXIT_FAILURE);
+// Rensningen tar detta lås runt varje steg, och mem_init och mem_deinit tar det också,
+// så ett steg körs aldrig mot en pool som håller på att skapas eller rivas.
+static pthread_mutex_t purge_lock = PTHREAD_MUTEX_INITIALIZER;
+static MemPurgeStats purge_stats;
+
+// Bakgrundstråden för rensning, skyddad av purge_thread_lock
+static pthread_mutex_t purge_thread_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t purge_wakeup = PTHREAD_COND_INITIALIZER;
+static pthread_t purge_thread;
+static int purge_running = 0;
+static int purge_stopping = 0;
+static uint64_t purge_decay_ns = 0;
+
+// Block per steg, mellan stegen släpps låsen så att allokeringar inte får vänta länge
+#define PURGE_STEP_BLOCKS 64
+
+// Stora allokeringar får egna mappningar utanför poolen och ligger i en hashtabell med
+// linjär sondering, nycklad på sidnumret. En tröskel på 0 stänger av vägen, då går allt
+// till strategin.
+typedef struct LargeBlock {
+    void* ptr;       // NULL för en tom plats
+    size_t length;   // Mappningens längd, en multipel av sidstorleken
+} LargeBlock;
+
+static pthread_mutex_t large_lock = PTHREAD_MUTEX_INITIALIZER;
+static LargeBlock* large_blocks = NULL;
+static size_t large_capacity = 0;      // Tvåpotens, tabellen hålls högst halvfull
+static atomic_size_t large_count = 0;  // Läses utan lås så att vanliga anrop slipper låset
+
+// Poolens adressintervall. En pekare där kan inte vara en stor allokering, så frigöring
+// av vanliga block slipper både låset och tabellen. Sätts bara av mem_init och mem_deinit.
+static char* pool_low = NULL;
+static size_t pool_span = 0;
+static size_t large_threshold = 0;
+static int large_threshold_set = 0;    // mem_set_large_threshold går före MM_LARGE_THRESHOLD
+static size_t large_limit = 0;         // Tröskeln som gäller för den nuvarande poolen
+
+static const MemBackend* find_backend(const char* name) {
+    for (size_t i = 0; i < BACKEND_COUNT; i++) {
+        if (strcmp(backends[i]->name, name) == 0) {
+            return backends[i];
+        }
     }
+    return NULL;
+}
 
-    total_pool_size = pool_size;
+// Ett okänt namn i MM_BACKEND ger en varning och first-fit, så programmet kan fortsätta
+static const MemBackend* choose_backend(void) {
+    if (selected != NULL) {
+        return selected;
+    }
+    const char* name = getenv("MM_BACKEND");
+    if (name == NULL || *name == '\0') {
+        return &mm_firstfit_backend;
+    }
+    const MemBackend* backend = find_backend(name);
+    if (backend == NULL) {
+        mem_report(MEM_ERR_UNKNOWN_BACKEND, NULL);  // ptr är bara för pekare in i poolen
+        return &mm_firstfit_backend;
+    }
+    return backend;
+}
 
-    // Skapa det första minnesblocket som täcker hela poolen
-    pool_head = (MemBlock*)malloc(sizeof(MemBlock));
-    if (!pool_head) {
-        perror("Misslyckades med att skapa blockmetadata");
-        free(pool_start);
-        exit(EXIT_FAILURE);
+int mem_set_backend(const char* name) {
+    if (name == NULL) {
+        selected = NULL;
+        return 0;
+    }
+    const MemBackend* backend = find_backend(name);
+    if (backend == NULL) {
+        return -1;
     }
+    selected = backend;
+    return 0;
+}
 
-    // Initialisera det första blocket som ledigt och täcker hela poolen
-    pool_head->block_size = pool_size;
-    pool_head->is_available = 1;        // Markera blocket som tillgängligt
-    pool_head->data_ptr = pool_start;   // Peka på startadressen av minnespoolen
-    pool_head->next_block = NULL;       // Inget nästa block än
+void mem_set_large_threshold(size_t threshold) {
+    pthread_mutex_lock(&large_lock);
+    large_threshold = threshold;
+    large_threshold_set = 1;
+    pthread_mutex_unlock(&large_lock);
 }
 
-void* mem_alloc(size_t size) {
-    MemBlock* current = pool_head;
-
-    // Traversera listan för att hitta ett ledigt block med tillräcklig storlek
-    while (current != NULL) {
-        if (current->is_available && current->block_size >= size) {
-            if (current->block_size > size) {
-                // Om blocket är större än behövligt, dela upp det i två block
-                MemBlock* new_block = (MemBlock*)malloc(sizeof(MemBlock));
-                if (!new_block) {
-                    perror("Misslyckades med att skapa nytt blockmetadata");
-                    return NULL;
-                }
-
-                // Initiera det nya blocket med den återstående storleken
-                new_block->block_size = current->block_size - size;
-                new_block->is_available = 1; // Nya blocket är tillgängligt
-                new_block->data_ptr = (char*)current->data_ptr + size; // Justera datapekaren
-                new_block->next_block = current->next_block; // Länka till nästa block
-
-                // Uppdatera det aktuella blocket till den begärda storleken och markera det som upptaget
-                current->block_size = size;
-                current->is_available = 0; // Markera som upptaget
-                current->next_block = new_block; // Länka till det nya blocket
-            } else {
-                // Om blockets storlek exakt matchar den begärda storleken, markera det som upptaget
-                current->is_available = 0;
-            }
+static void choose_large_threshold(void) {
+    pthread_mutex_lock(&large_lock);
+    if (!large_threshold_set) {
+        const char* value = getenv("MM_LARGE_THRESHOLD");
+        large_threshold = value != NULL ? (size_t) strtoull(value, NULL, 10) : 0;
+    }
+    large_limit = large_threshold;
+    pthread_mutex_unlock(&large_lock);
+}
+
+static size_t round_to_page(size_t size) {
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    return (size + page - 1) / page * page;
+}
+
+static inline int in_pool(const void* ptr) {
+    return (uintptr_t) ptr - (uintptr_t) pool_low < pool_span;
+}
+
+// Första platsen att pröva för pekaren, mappningar börjar alltid på en sida
+static size_t large_home(const void* ptr) {
+    return (size_t) (((uintptr_t) ptr >> 12) * 0x9E3779B97F4A7C15ull) & (large_capacity - 1);
+}
+
+// Platsen i tabellen för pekaren, anropas med large_lock taget
+static LargeBlock* find_large(const void* ptr) {
+    if (large_capacity == 0) {
+        return NULL;
+    }
+    for (size_t i = large_home(ptr);; i = (i + 1) & (large_capacity - 1)) {
+        if (large_blocks[i].ptr == ptr) {
+            return &large_blocks[i];
+        }
+        if (large_blocks[i].ptr == NULL) {
+            return NULL;
+        }
+    }
+}
+
+// Lägg in en post, tabellen måste ha plats. Anropas med large_lock taget.
+static void insert_large(void* ptr, size_t length) {
+    size_t i = large_home(ptr);
+    while (large_blocks[i].ptr != NULL) {
+        i = (i + 1) & (large_capacity - 1);
+    }
+    large_blocks[i].ptr = ptr;
+    large_blocks[i].length = length;
+    atomic_store_explicit(&large_count, atomic_load_explicit(&large_count, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+}
+
+// Ta bort en post och flytta bakåt de efterföljande som annars inte längre hittas
+static void remove_large(LargeBlock* block) {
+    size_t mask = large_capacity - 1;
+    size_t hole = (size_t) (block - large_blocks);
+    for (size_t i = (hole + 1) & mask; large_blocks[i].ptr != NULL; i = (i + 1) & mask) {
+        size_t home = large_home(large_blocks[i].ptr);
+        // Posten får flyttas till hålet om hålet ligger mellan dess hemplats och den
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            large_blocks[hole] = large_blocks[i];
+            hole = i;
+        }
+    }
+    large_blocks[hole].ptr = NULL;
+    atomic_store_explicit(&large_count, atomic_load_explicit(&large_count, memory_order_relaxed) - 1,
+                          memory_order_relaxed);
+}
+
+// Dubbla tabellen och lägg in alla poster igen. Anropas med large_lock taget.
+static int grow_large_table(void) {
+    size_t old_capacity = large_capacity;
+    LargeBlock* old = large_blocks;
+    size_t capacity = old_capacity ? old_capacity * 2 : 16;
+    LargeBlock* grown = (LargeBlock*) calloc(capacity, sizeof(LargeBlock));
+    if (!grown) {
+        return -1;
+    }
+    large_blocks = grown;
+    large_capacity = capacity;
+    atomic_store_explicit(&large_count, 0, memory_order_relaxed);
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old[i].ptr != NULL) {
+            insert_large(old[i].ptr, old[i].length);
+        }
+    }
+    free(old);
+    return 0;
+}
+
+static void* large_alloc(size_t size) {
+    size_t length = round_to_page(size);
+    void* ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&large_lock);
+    size_t count = atomic_load_explicit(&large_count, memory_order_relaxed);
+    if (2 * (count + 1) > large_capacity && grow_large_table() != 0) {
+        pthread_mutex_unlock(&large_lock);
+        munmap(ptr, length);
+        return NULL;
+    }
+    insert_large(ptr, length);
+    pthread_mutex_unlock(&large_lock);
+    return ptr;
+}
+
+// Returnerar 1 om pekaren var en stor allokering och nu är frigjord.
+// Mappningen tas bort efter att låset släppts, så andra trådar inte väntar på munmap.
+static int large_free(void* ptr) {
+    if (atomic_load_explicit(&large_count, memory_order_relaxed) == 0 || in_pool(ptr)) {
+        return 0;
+    }
+    pthread_mutex_lock(&large_lock);
+    LargeBlock* block = find_large(ptr);
+    if (block == NULL) {
+        pthread_mutex_unlock(&large_lock);
+        return 0;
+    }
+    size_t length = block->length;
+    remove_large(block);
+    pthread_mutex_unlock(&large_lock);
+    munmap(ptr, length);
+    return 1;
+}
+
+// Ändra storlek med mremap, sidorna flyttas av kärnan utan någon kopiering.
+// Sätter *handled till 0 om pekaren inte var en stor allokering.
+static void* large_resize(void* ptr, size_t size, int* handled) {
+    *handled = 0;
+    if (atomic_load_explicit(&large_count, memory_order_relaxed) == 0 || in_pool(ptr)) {
+        return NULL;
+    }
+    pthread_mutex_lock(&large_lock);
+    LargeBlock* block = find_large(ptr);
+    if (block == NULL) {
+        pthread_mutex_unlock(&large_lock);
+        return NULL;
+    }
+    *handled = 1;
+
+    size_t length = round_to_page(size ? size : 1);
+    void* moved = ptr;
+    if (length != block->length) {
+        moved = mremap(block->ptr, block->length, length, MREMAP_MAYMOVE);
+        if (moved == MAP_FAILED) {
+            pthread_mutex_unlock(&large_lock);
+            return NULL;  // Det gamla blocket är orört
+        }
+        // Nyckeln kan ha ändrats, posten läggs in på nytt. Antalet är oförändrat, så det finns plats.
+        remove_large(block);
+        insert_large(moved, length);
+    }
+    pthread_mutex_unlock(&large_lock);
+    return moved;
+}
+
+// Stora allokeringar hör till poolen och försvinner med den
+static void large_release_all(void) {
+    pthread_mutex_lock(&large_lock);
+    for (size_t i = 0; i < large_capacity; i++) {
+        if (large_blocks[i].ptr != NULL) {
+            munmap(large_blocks[i].ptr, large_blocks[i].length);
+        }
+    }
+    free(large_blocks);
+    large_blocks = NULL;
+    large_capacity = 0;
+    atomic_store_explicit(&large_count, 0, memory_order_relaxed);
+    pthread_mutex_unlock(&large_lock);
+}
+
+// Kom ihåg poolens intervall efter att strategin skapat den. span får vara mindre än
+// det som faktiskt är mappat, pekare utanför går bara den långsammare vägen.
+static void remember_pool(size_t span) {
+    pool_low = (char*) active->pool_base();
+    pool_span = pool_low != NULL ? span : 0;
+}
+
+// ---- Uppskjuten frigöring ----
+
+// Varje tråd samlar pekare i en egen buffert utan lås. En full buffert läggs i en
+// gemensam kö som töms med mem_free_batch, av återvinningstråden eller av mem_free_drain.
+#define DEFERRED_BATCH 256
+
+typedef struct DeferredBuffer {
+    struct DeferredBuffer* next;
+    unsigned long generation;  // Poolen pekarna hör till, se deferred_generation
+    size_t count;
+    void* ptrs[DEFERRED_BATCH];
+} DeferredBuffer;
+
+static pthread_mutex_t deferred_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t deferred_wakeup = PTHREAD_COND_INITIALIZER;
+static DeferredBuffer* deferred_queue = NULL;   // Fulla buffertar som väntar på att tömmas
+static DeferredBuffer* deferred_spare = NULL;   // Tomma buffertar att återanvända
+static atomic_size_t deferred_queued = 0;
+// mem_deinit räknar upp generationen, pekare från en tidigare pool kastas i stället för att frigöras
+static atomic_ulong deferred_generation = 0;
+// Tas runt varje tömning så att mem_deinit inte river poolen mitt i en
+static pthread_mutex_t drain_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_t reclaimer_thread;
+static int reclaimer_running = 0;
+static int reclaimer_stopping = 0;
+
+static __thread DeferredBuffer* local_buffer = NULL;
+static pthread_key_t local_buffer_key;
+static pthread_once_t local_buffer_once = PTHREAD_ONCE_INIT;
+
+static DeferredBuffer* take_buffer(void) {
+    pthread_mutex_lock(&deferred_lock);
+    DeferredBuffer* buffer = deferred_spare;
+    if (buffer != NULL) {
+        deferred_spare = buffer->next;
+    }
+    pthread_mutex_unlock(&deferred_lock);
+    if (buffer == NULL) {
+        buffer = (DeferredBuffer*) malloc(sizeof(DeferredBuffer));
+        if (!buffer) {
+            return NULL;
+        }
+    }
+    buffer->count = 0;
+    buffer->generation = atomic_load_explicit(&deferred_generation, memory_order_relaxed);
+    return buffer;
+}
+
+static void publish_buffer(DeferredBuffer* buffer) {
+    pthread_mutex_lock(&deferred_lock);
+    buffer->next = deferred_queue;
+    deferred_queue = buffer;
+    atomic_fetch_add_explicit(&deferred_queued, 1, memory_order_relaxed);
+    pthread_cond_signal(&deferred_wakeup);
+    pthread_mutex_unlock(&deferred_lock);
+}
+
+// En tråd som avslutas lämnar sina väntande pekare till kön
+static void release_local_buffer(void* arg) {
+    DeferredBuffer* buffer = (DeferredBuffer*) arg;
+    if (buffer->count > 0) {
+        publish_buffer(buffer);
+    } else {
+        pthread_mutex_lock(&deferred_lock);
+        buffer->next = deferred_spare;
+        deferred_spare = buffer;
+        pthread_mutex_unlock(&deferred_lock);
+    }
+    local_buffer = NULL;
+}
+
+static void create_local_buffer_key(void) {
+    pthread_key_create(&local_buffer_key, release_local_buffer);
+}
+
+// Töm alla köade buffertar med en batchfrigöring per buffert
+static void drain_queue(void) {
+    pthread_mutex_lock(&drain_lock);
+    pthread_mutex_lock(&deferred_lock);
+    DeferredBuffer* buffer = deferred_queue;
+    deferred_queue = NULL;
+    atomic_store_explicit(&deferred_queued, 0, memory_order_relaxed);
+    pthread_mutex_unlock(&deferred_lock);
+
+    unsigned long generation = atomic_load_explicit(&deferred_generation, memory_order_relaxed);
+    DeferredBuffer* last = NULL;
+    for (DeferredBuffer* current = buffer; current != NULL; current = current->next) {
+        if (current->generation == generation) {
+            mem_free_batch(current->ptrs, current->count);
+        }
+        current->count = 0;
+        last = current;
+    }
+    pthread_mutex_unlock(&drain_lock);
+
+    if (last != NULL) {
+        pthread_mutex_lock(&deferred_lock);
+        last->next = deferred_spare;
+        deferred_spare = buffer;
+        pthread_mutex_unlock(&deferred_lock);
+    }
+}
+
+// Frigör en buffert direkt, när ingen ny buffert finns att byta till
+static void free_buffer_now(DeferredBuffer* buffer) {
+    pthread_mutex_lock(&drain_lock);
+    if (buffer->generation == atomic_load_explicit(&deferred_generation, memory_order_relaxed)) {
+        mem_free_batch(buffer->ptrs, buffer->count);
+    }
+    buffer->count = 0;
+    pthread_mutex_unlock(&drain_lock);
+}
+
+// Lämna en full buffert till kön och fortsätt i en tom
+static void swap_local_buffer(DeferredBuffer* buffer) {
+    DeferredBuffer* fresh = take_buffer();
+    if (fresh == NULL) {
+        free_buffer_now(buffer);
+        return;
+    }
+    publish_buffer(buffer);
+    local_buffer = fresh;
+    pthread_setspecific(local_buffer_key, fresh);
+}
+
+void mem_free_deferred(void* block) {
+    if (!block) {
+        mem_report(MEM_ERR_NULL_FREE, NULL);
+        return;
+    }
+    mm_profile_free(block);
 
-            // Returnera pekaren till det allokerade dataområdet
-            return current->data_ptr;
+    DeferredBuffer* buffer = local_buffer;
+    if (buffer == NULL) {
+        pthread_once(&local_buffer_once, create_local_buffer_key);
+        buffer = take_buffer();
+        if (buffer == NULL) {
+            mem_free(block);  // Inget minne för en buffert, frigör direkt
+            return;
         }
-        current = current->next_block; // Gå vidare till nästa block i listan
+        local_buffer = buffer;
+        pthread_setspecific(local_buffer_key, buffer);
     }
 
-    // Returnera NULL om inget lämpligt block hittades
+    // Pekare från en pool som har avinitierats frigörs aldrig
+    unsigned long generation = atomic_load_explicit(&deferred_generation, memory_order_relaxed);
+    if (buffer->generation != generation) {
+        buffer->count = 0;
+        buffer->generation = generation;
+    }
+
+    buffer->ptrs[buffer->count++] = block;
+    if (buffer->count == DEFERRED_BATCH) {
+        swap_local_buffer(buffer);
+    }
+}
+
+void mem_free_drain(void) {
+    DeferredBuffer* buffer = local_buffer;
+    if (buffer != NULL && buffer->count > 0) {
+        swap_local_buffer(buffer);
+    }
+    drain_queue();
+}
+
+static void* reclaimer_main(void* arg) {
+    (void) arg;
+    pthread_mutex_lock(&deferred_lock);
+    while (!reclaimer_stopping) {
+        if (deferred_queue == NULL) {
+            pthread_cond_wait(&deferred_wakeup, &deferred_lock);
+            continue;
+        }
+        pthread_mutex_unlock(&deferred_lock);
+        drain_queue();
+        pthread_mutex_lock(&deferred_lock);
+    }
+    pthread_mutex_unlock(&deferred_lock);
     return NULL;
 }
 
-void mem_free(void* ptr) {
-    if (!ptr) {
-        fprintf(stderr, "Varning: Försökte frigöra en NULL-pekare.\n");
+int mem_reclaimer_start(void) {
+    int result = 0;
+    pthread_mutex_lock(&deferred_lock);
+    if (!reclaimer_running) {
+        reclaimer_stopping = 0;
+        if (pthread_create(&reclaimer_thread, NULL, reclaimer_main, NULL) == 0) {
+            reclaimer_running = 1;
+        } else {
+            result = -1;
+        }
+    }
+    pthread_mutex_unlock(&deferred_lock);
+    return result;
+}
+
+void mem_reclaimer_stop(void) {
+    pthread_mutex_lock(&deferred_lock);
+    if (!reclaimer_running) {
+        pthread_mutex_unlock(&deferred_lock);
         return;
     }
+    reclaimer_stopping = 1;
+    pthread_cond_signal(&deferred_wakeup);
+    pthread_mutex_unlock(&deferred_lock);
 
-    MemBlock* current = pool_head;
-    while (current != NULL) {
-        if (current->data_ptr == ptr) {
-            if (current->is_available) {
-                fprintf(stderr, "Varning: Blocket vid %p är redan fritt.\n", ptr);
-                return;
-            }
+    pthread_join(reclaimer_thread, NULL);
 
-            // Markera blocket som ledigt
-            current->is_available = 1;
+    pthread_mutex_lock(&deferred_lock);
+    reclaimer_running = 0;
+    pthread_mutex_unlock(&deferred_lock);
+}
 
-            // Försök att slå samman med nästa block om det också är ledigt, för att undvika fragmentering
-            MemBlock* next_block = current->next_block;
-            while (next_block != NULL && next_block->is_available) {
-                current->block_size += next_block->block_size; // Öka storleken på det nuvarande blocket
-                current->next_block = next_block->next_block; // Hoppa över nästa block i listan
-                free(next_block); // Frigör metadata för nästa block
-                next_block = current->next_block; // Uppdatera pekaren till nästa block
-            }
+// Pekare som väntar när poolen rivs hör till den och kastas
+static void discard_deferred(void) {
+    pthread_mutex_lock(&deferred_lock);
+    atomic_fetch_add_explicit(&deferred_generation, 1, memory_order_relaxed);
+    DeferredBuffer* buffer = deferred_queue;
+    while (buffer != NULL) {
+        DeferredBuffer* next = buffer->next;
+        buffer->next = deferred_spare;
+        deferred_spare = buffer;
+        buffer = next;
+    }
+    deferred_queue = NULL;
+    atomic_store_explicit(&deferred_queued, 0, memory_order_relaxed);
+    pthread_mutex_unlock(&deferred_lock);
+}
 
-            return;
+const char* mem_backend_name(void) {
+    return active->name;
+}
+
+void mem_init(size_t size) {
+    pthread_mutex_lock(&purge_lock);
+    active = choose_backend();
+    choose_large_threshold();
+    mm_profile_from_env();
+    active->init(size);
+    remember_pool(size);
+    pthread_mutex_unlock(&purge_lock);
+}
+
+void mem_init_growable(size_t initial_size, size_t max_size) {
+    pthread_mutex_lock(&purge_lock);
+    active = choose_backend();
+    choose_large_threshold();
+    mm_profile_from_env();
+    active->init_growable(initial_size, max_size);
+    remember_pool(max_size > initial_size ? max_size : initial_size);  // Reservationen är minst så stor
+    pthread_mutex_unlock(&purge_lock);
+}
+
+// En fil- eller delad pool kräver TLSF, där allt tillstånd är index som gäller var
+// poolen än mappas. Stora allokeringar skulle hamna utanför den, så den vägen är avstängd.
+int mem_init_file(const char* path, size_t size) {
+    pthread_mutex_lock(&purge_lock);
+    active = &mm_tlsf_backend;
+    pthread_mutex_lock(&large_lock);
+    large_limit = 0;
+    pthread_mutex_unlock(&large_lock);
+    int result = tlsf_init_file(path, size);
+    pthread_mutex_unlock(&purge_lock);
+    return result;
+}
+
+int mem_init_shared(const char* name, size_t size) {
+    pthread_mutex_lock(&purge_lock);
+    active = &mm_tlsf_backend;
+    pthread_mutex_lock(&large_lock);
+    large_limit = 0;
+    pthread_mutex_unlock(&large_lock);
+    int result = tlsf_init_shared(name, size);
+    pthread_mutex_unlock(&purge_lock);
+    return result;
+}
+
+int mem_unlink_shared(const char* name) {
+    return shm_unlink(name);
+}
+
+int mem_set_root(void* block) {
+    return active == &mm_tlsf_backend ? tlsf_set_root(block) : -1;
+}
+
+void* mem_root(void) {
+    return active == &mm_tlsf_backend ? tlsf_root() : NULL;
+}
+
+int mem_reserve(size_t size) {
+    return active->reserve(size);
+}
+
+void* mem_alloc(size_t size) {
+    void* block;
+    if (large_limit != 0 && size >= large_limit) {
+        block = large_alloc(size);
+    } else {
+        block = active->alloc(size);
+        if (block == NULL && (local_buffer != NULL || atomic_load_explicit(&deferred_queued, memory_order_relaxed) != 0)) {
+            // Uppskjutna frigöringar kan ge plats, töm dem och försök igen
+            mem_free_drain();
+            block = active->alloc(size);
+        }
+    }
+    mm_profile_alloc(block, size);
+    return block;
+}
+
+// Nya mappningar är redan nollställda, och strategier som vet vilket ledigt minne som
+// fortfarande är noll hoppar över memset för det
+void* mem_calloc(size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+    size_t total = count * size;
+    void* block;
+    if (large_limit != 0 && total >= large_limit) {
+        block = large_alloc(total);
+    } else if (active->alloc_zeroed != NULL) {
+        block = active->alloc_zeroed(total);
+    } else {
+        block = active->alloc(total);
+        if (block != NULL) {
+            memset(block, 0, total);
         }
-        current = current->next_block; // Gå vidare till nästa block i listan
     }
+    mm_profile_alloc(block, total);
+    return block;
+}
 
-    // Om pekaren inte hittas i poolen, ge en varning
-    fprintf(stderr, "Varning: Pekaren %p var inte allokerad från denna pool.\n", ptr);
+// Körningen provtas som en allokering och följs tills dess första element frigörs
+void* mem_alloc_contiguous(size_t size, size_t count) {
+    void* block = active->alloc_contiguous(size, count);
+    mm_profile_alloc(block, size * count);
+    return block;
 }
 
-void* mem_resize(void* ptr, size_t size) {
-    if (!ptr) return mem_alloc(size); // Om pekaren är NULL, allokera nytt minne
+void mem_free(void* block) {
+    mm_profile_free(block);
+    if (!large_free(block)) {
+        active->free(block);
+    }
+}
 
-    MemBlock* block = pool_head;
-    while (block != NULL) {
-        if (block->data_ptr == ptr) {
-            if (block->block_size >= size) {
-                return ptr; // Nuvarande block är tillräckligt stort, returnera samma pekare
-            } else {
-                // Allokera ett nytt block med den önskade storleken
-                void* new_ptr = mem_alloc(size);
-                if (new_ptr) {
-                    // Kopiera data från det gamla blocket till det nya
-                    memcpy(new_ptr, ptr, block->block_size);
-                    // Frigör det gamla blocket
-                    mem_free(ptr);
-                }
-                return new_ptr; // Returnera pekaren till det nya blocket eller NULL om allokering misslyckades
+void mem_free_batch(void** blocks, size_t count) {
+    // Stora allokeringar plockas bort ur arrayen innan resten går till strategin
+    if (atomic_load_explicit(&mm_profile_live, memory_order_relaxed) != 0) {
+        for (size_t i = 0; i < count; i++) {
+            mm_profile_forget(blocks[i]);
+        }
+    }
+    size_t kept = count;
+    if (atomic_load_explicit(&large_count, memory_order_relaxed) != 0) {
+        kept = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!large_free(blocks[i])) {
+                blocks[kept++] = blocks[i];
             }
         }
-        block = block->next_block; // Gå vidare till nästa block i listan
     }
+    active->free_batch(blocks, kept);
+}
+
+// Ett block i poolen som växer över tröskeln flyttas en gång till en egen mappning,
+// sedan växer det med mremap utan kopiering. Stora block förblir stora även när de
+// krymper under tröskeln, så ett block flyttas aldrig fram och tillbaka.
+static void* move_to_large(void* block, size_t size) {
+    size_t used = active->usable_size(block);
+    if (used == 0) {
+        return active->resize(block, size);  // Strategin rapporterar den okända pekaren
+    }
+    void* moved = large_alloc(size);
+    if (moved != NULL) {
+        memcpy(moved, block, used < size ? used : size);
+        active->free(block);
+    }
+    return moved;
+}
+
+// För profileraren är en storleksändring en frigöring följd av en ny allokering
+void* mem_resize(void* block, size_t size) {
+    int handled;
+    void* moved = large_resize(block, size, &handled);
+    if (!handled) {
+        if (large_limit != 0 && size >= large_limit && block == NULL) {
+            moved = large_alloc(size);
+        } else if (large_limit != 0 && size >= large_limit && active->usable_size != NULL) {
+            moved = move_to_large(block, size);
+        } else {
+            moved = active->resize(block, size);
+        }
+    }
+    if (moved != NULL) {
+        mm_profile_free(block);
+        mm_profile_alloc(moved, size);
+    }
+    return moved;
+}
+
+void mem_deinit(void) {
+    pthread_mutex_lock(&drain_lock);
+    discard_deferred();
+    pthread_mutex_lock(&purge_lock);
+    large_release_all();
+    pool_span = 0;
+    active->deinit();
+    mm_profile_reset_live();
+    pthread_mutex_unlock(&purge_lock);
+    pthread_mutex_unlock(&drain_lock);
+}
+
+void* mem_pool_base(void) {
+    return active->pool_base();
+}
+
+// ---- Rensning av oanvänt ledigt minne ----
+
+// En hel genomgång i små steg, returnerar antalet byte som lämnades tillbaka
+static size_t purge_pass(uint64_t decay_ns) {
+    size_t before;
+    size_t visited;
+    pthread_mutex_lock(&purge_lock);
+    before = purge_stats.bytes;
+    pthread_mutex_unlock(&purge_lock);
+
+    do {
+        pthread_mutex_lock(&purge_lock);
+        visited = active->purge != NULL ? active->purge(decay_ns, PURGE_STEP_BLOCKS, &purge_stats) : 0;
+        pthread_mutex_unlock(&purge_lock);
+    } while (visited == PURGE_STEP_BLOCKS);
 
-    // Om pekaren inte hittas i poolen, ge en varning
-    fprintf(stderr, "Varning: Ändring av storlek misslyckades, pekaren %p hittades inte.\n", ptr);
+    pthread_mutex_lock(&purge_lock);
+    purge_stats.passes++;
+    size_t purged = purge_stats.bytes - before;
+    pthread_mutex_unlock(&purge_lock);
+    return purged;
+}
+
+size_t mem_purge(unsigned decay_ms) {
+    return purge_pass((uint64_t) decay_ms * 1000000u);
+}
+
+// Tråden vaknar fyra gånger per avklingningstid, så ett block lämnas tillbaka
+// senast en kvarts avklingningstid efter att det blev gammalt nog
+static void* purge_main(void* arg) {
+    (void) arg;
+    pthread_mutex_lock(&purge_thread_lock);
+    while (!purge_stopping) {
+        uint64_t interval = purge_decay_ns / 4;
+        if (interval < 1000000u) {
+            interval = 1000000u;
+        } else if (interval > 1000000000u) {
+            interval = 1000000000u;
+        }
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        uint64_t nsec = (uint64_t) deadline.tv_nsec + interval;
+        deadline.tv_sec += nsec / 1000000000u;
+        deadline.tv_nsec = nsec % 1000000000u;
+        int rc = 0;
+        while (!purge_stopping && rc != ETIMEDOUT) {
+            rc = pthread_cond_timedwait(&purge_wakeup, &purge_thread_lock, &deadline);
+        }
+        if (purge_stopping) {
+            break;
+        }
+
+        uint64_t decay_ns = purge_decay_ns;
+        pthread_mutex_unlock(&purge_thread_lock);
+        purge_pass(decay_ns);
+        pthread_mutex_lock(&purge_thread_lock);
+    }
+    pthread_mutex_unlock(&purge_thread_lock);
     return NULL;
 }
 
-// Funktion för att avinitiera minnespoolen och frigöra alla resurser
-void mem_deinit() {
-    free(pool_start); // Frigör hela minnespoolen
-    pool_start = NULL; // Sätt pool_start till NULL för att undvika hängande pekare
+int mem_purge_start(unsigned decay_ms) {
+    int result = 0;
+    pthread_mutex_lock(&purge_thread_lock);
+    purge_decay_ns = (uint64_t) decay_ms * 1000000u;  // En tråd som redan går läser den vid nästa varv
+    if (!purge_running) {
+        purge_stopping = 0;
+        if (pthread_create(&purge_thread, NULL, purge_main, NULL) == 0) {
+            purge_running = 1;
+        } else {
+            result = -1;
+        }
+    }
+    pthread_mutex_unlock(&purge_thread_lock);
+    return result;
+}
 
-    MemBlock* current = pool_head;
-    while (current != NULL) {
-        MemBlock* next = current->next_block; // Spara nästa block
-        free(current); // Frigör nuvarande blockmetadata
-        current = next; // Gå vidare till nästa block
+void mem_purge_stop(void) {
+    pthread_mutex_lock(&purge_thread_lock);
+    if (!purge_running) {
+        pthread_mutex_unlock(&purge_thread_lock);
+        return;
     }
+    purge_stopping = 1;
+    pthread_cond_signal(&purge_wakeup);
+    pthread_mutex_unlock(&purge_thread_lock);
+
+    pthread_join(purge_thread, NULL);
 
-    pool_head = NULL;        // Sätt pool_head till NULL för att indikera att listan är tom
-    total_pool_size = 0;     // Återställ den totala poolstorleken till 0
-}
\ No newline at end of file
+    pthread_mutex_lock(&purge_thread_lock);
+    purge_running = 0;
+    pthread_mutex_unlock(&purge_thread_lock);
+}
+
+void mem_purge_stats(MemPurgeStats* stats) {
+    pthread_mutex_lock(&purge_lock);
+    *stats = purge_stats;
+    stats->released_bytes = active->released != NULL ? active->released() : 0;
+    pthread_mutex_unlock(&purge_lock);
+}
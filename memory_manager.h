@@ -5,11 +5,182 @@
 #define MEMORY_MANAGER_H
 
 #include <stddef.h> // Includes the standard library for size_t, which represents sizes in bytes
+#include <stdint.h>
+
+// All mem_* functions are safe to call from several threads at once.
+
+// Chooses the allocation strategy used by the next mem_init or
+// mem_init_growable: "firstfit", "bestfit", "buddy" or "tlsf". Without a
+// call the MM_BACKEND environment variable decides, and first-fit is the
+// default. NULL goes back to that. Returns -1 for an unknown name.
+int mem_set_backend(const char* name);
+// Name of the strategy behind the current pool.
+const char* mem_backend_name(void);
+// Requests of at least 'threshold' bytes bypass the pool and get their own
+// page-aligned mapping, which mem_resize grows or shrinks with mremap and no
+// copying. A pool block resized past the threshold is copied once into such
+// a mapping. 0 turns this off, which is the default. Without a call the
+// MM_LARGE_THRESHOLD environment variable is used. Either takes effect at
+// the next mem_init.
+void mem_set_large_threshold(size_t threshold);
+
 void mem_init(size_t size);
+// Like mem_init, but the pool grows on demand, at least doubling each time,
+// up to max_size bytes (0 picks a default). Address space for max_size is
+// reserved up front, so blocks never move when the pool grows.
+void mem_init_growable(size_t initial_size, size_t max_size);
+// Maps a pool of 'size' bytes from a file with MAP_SHARED, using the TLSF
+// backend. All allocator state lives in the file as offsets, so a later
+// process can reopen the pool and find its blocks where it left them; data
+// inside the pool must link with offsets too (see compact_list.h). An
+// existing file keeps its own size. Every open checks the pool's
+// consistency; a damaged pool is recreated empty.
+// Returns 0 if a new pool was created, 1 if a cleanly closed pool was
+// reopened, 2 if the pool was not closed with mem_deinit but passed the
+// check, and -1 on error.
+int mem_init_file(const char* path, size_t size);
+// Creates or attaches to a pool in the POSIX shared-memory object 'name'
+// (for example "/my_pool"), laid out like a file-backed pool. Every process
+// may map it at a different address, so data in it must link with offsets.
+// Allocation is serialized across processes with a robust process-shared
+// mutex; if a process dies holding it, the next one repairs the free lists.
+// Returns 0 if this process created the pool, 1 if it attached to an
+// existing one, and -1 on error. mem_deinit detaches; the object lives on
+// until mem_unlink_shared.
+int mem_init_shared(const char* name, size_t size);
+int mem_unlink_shared(const char* name);
+// The root is a block of a file-backed or shared pool that survives
+// reopening, the entry point to the structures kept in it. NULL clears it.
+// Returns -1 if the pool is not file-backed or the block is not from it.
+int mem_set_root(void* block);
+void* mem_root(void);
+// Makes sure a later allocation of 'size' bytes needs no growth.
+// Returns 0 on success and -1 if the pool cannot provide it.
+int mem_reserve(size_t size);
+// Every block, and the first element of a contiguous run, is aligned for
+// any type (max_align_t).
 void* mem_alloc(size_t size);
+// Allocates 'count' elements of 'size' bytes that read as zero, or returns
+// NULL if the product overflows. Memory known to be untouched since the OS
+// handed it out, or purged since, is not cleared again.
+void* mem_calloc(size_t count, size_t size);
+// Allocates 'count' elements of 'size' bytes back to back in one run.
+// Each element can later be released on its own with mem_free. Backends
+// that tag blocks in fixed units return NULL for other element sizes: TLSF
+// needs a multiple of 16 bytes, buddy a power of two of at least 16.
+void* mem_alloc_contiguous(size_t size, size_t count);
 void mem_free(void* block);
+// Frees 'count' blocks with a single pass over the pool and coalesces once.
+// The array may be reordered.
+void mem_free_batch(void** blocks, size_t count);
+// Queues a block to be freed later, in constant time and without taking the
+// pool lock. Each thread fills its own buffer; full buffers are freed with
+// mem_free_batch by the reclaimer thread, or by mem_free_drain at a point
+// the program picks. A mem_alloc that fails drains before giving up, and
+// blocks still queued at mem_deinit are dropped with the pool.
+void mem_free_deferred(void* block);
+// Frees everything queued so far, including this thread's partial buffer.
+void mem_free_drain(void);
+// Starts a thread that frees each full buffer as soon as it is queued.
+// Returns 0 on success.
+int mem_reclaimer_start(void);
+void mem_reclaimer_stop(void);
 void* mem_resize(void* block, size_t size);
 void mem_deinit(void);
+// Start address of the pool; offsets from it stay valid for the pool's lifetime.
+void* mem_pool_base(void);
+
+// Free memory that stays unused for a decay time is handed back to the OS
+// with madvise, so the resident size shrinks after a spike. Only the
+// first-fit and best-fit backends purge; with the others these are no-ops.
+typedef struct MemPurgeStats {
+    size_t passes;          // Completed passes over the pool
+    size_t ranges;          // Ranges handed back to the OS
+    size_t bytes;           // Bytes handed back to the OS in total
+    size_t released_bytes;  // Free bytes currently handed back and not reused
+} MemPurgeStats;
+
+// Runs one full pass now and returns the bytes it handed back.
+size_t mem_purge(unsigned decay_ms);
+// Starts a background thread that purges in small steps, so mem_free never
+// pays for it. Calling it again changes the decay time. Returns 0 on success.
+int mem_purge_start(unsigned decay_ms);
+void mem_purge_stop(void);
+void mem_purge_stats(MemPurgeStats* stats);
+
+// Errors found by the memory manager and the lists are counted and recorded
+// without locks: each code has an atomic counter, the latest events are kept
+// in a fixed ring buffer, and an optional callback sees every event as it
+// happens. Printing to stderr is a single write(2) per line on the reporting
+// thread, often with a pool lock held. It bypasses stdio and is rate limited,
+// but a slow stderr still delays that thread.
+typedef enum MemError {
+    MEM_OK = 0,
+    MEM_ERR_NULL_FREE,          // mem_free(NULL)
+    MEM_ERR_DOUBLE_FREE,        // The block is already free
+    MEM_ERR_FOREIGN_POINTER,    // The pointer is not a block of this pool
+    MEM_ERR_RESIZE_UNKNOWN,     // mem_resize on a pointer that was not found
+    MEM_ERR_OUT_OF_MEMORY,      // An allocation could not be satisfied
+    MEM_ERR_NULL_NODE,          // A list operation was given a NULL node
+    MEM_ERR_NODE_NOT_IN_LIST,   // The given node is not in the list
+    MEM_ERR_LIST_EMPTY,         // Removal from an empty list
+    MEM_ERR_DATA_NOT_FOUND,     // No node holds the requested value
+    MEM_ERR_POOL_CORRUPT,       // A file-backed or shared pool failed its check
+    MEM_ERR_UNKNOWN_BACKEND,    // MM_BACKEND names no backend
+    MEM_ERROR_COUNT
+} MemError;
+
+typedef struct MemEvent {
+    MemError code;
+    const void* ptr;   // The pointer involved, or NULL
+    uint64_t time_ns;  // CLOCK_MONOTONIC
+} MemEvent;
+
+// Runs on the reporting thread, possibly with a pool lock held, so it must
+// not call back into the memory manager.
+typedef void (*MemErrorCallback)(const MemEvent* event, void* ctx);
+
+void mem_report(MemError code, const void* ptr);
+const char* mem_error_string(MemError code);
+// The last error reported on the calling thread, MEM_OK if none.
+MemError mem_last_error(void);
+uint64_t mem_error_count(MemError code);
+// Zeroes the counters; the ring buffer keeps its events.
+void mem_reset_errors(void);
+// Copies up to 'max' of the latest events, oldest first, and returns how
+// many were copied. At most 256 events are kept.
+size_t mem_recent_errors(MemEvent* events, size_t max);
+// NULL removes the callback.
+void mem_set_error_callback(MemErrorCallback fn, void* ctx);
+// At most this many lines per second go to stderr, the rest are counted and
+// summarized. 0 turns printing off. The default is 10.
+void mem_set_error_output(int lines_per_second);
+
+// Sampling heap profiler. About one allocation per 'sample_bytes' allocated
+// bytes records its call stack and size, and stays tracked as live until it
+// is freed. Sampling costs a thread-local countdown per allocation, and a
+// lock-free table lookup per free while sampled blocks are live, so it can
+// stay on in production. Without a call the MM_PROFILE_RATE environment
+// variable is used at mem_init; 512 KiB is a usual rate.
+typedef struct MemProfileStats {
+    size_t samples;       // Allocations sampled so far
+    size_t dropped;       // Samples lost because a table was full
+    size_t live_samples;  // Sampled allocations not yet freed
+    size_t live_bytes;    // Their sizes, not scaled up
+} MemProfileStats;
+
+// Returns 0 on success. Calling it again changes the rate.
+int mem_profile_start(size_t sample_bytes);
+// Stops sampling; blocks sampled earlier are still tracked until freed.
+void mem_profile_stop(void);
+void mem_profile_stats(MemProfileStats* stats);
+// Writes the profile in the legacy pprof heap format, readable with
+// "pprof <program> <path>". Returns 0 on success.
+int mem_profile_dump(const char* path);
+// Dumps the profile to "<prefix>.<pid>.<n>.heap" each time 'signo' arrives.
+// The handler only wakes a thread that writes the file. Returns 0 on success.
+int mem_profile_dump_on_signal(int signo, const char* prefix);
+void mem_profile_dump_on_signal_stop(void);
 
 #endif // MEMORY_MANAGER_H
 
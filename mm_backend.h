@@ -0,0 +1,84 @@
+#ifndef MM_BACKEND_H
+#define MM_BACKEND_H
+
+#include <stdint.h>
+#include <time.h>
+#include <stdatomic.h>
+#include "memory_manager.h"
+
+// Internal interface between memory_manager.c and the allocator backends.
+// Each backend implements the whole public API over its own pool; the
+// memory manager forwards every mem_* call to the backend chosen at init.
+typedef struct MemBackend {
+    const char* name;
+    void (*init)(size_t size);
+    void (*init_growable)(size_t initial_size, size_t max_size);
+    void* (*alloc)(size_t size);
+    void* (*alloc_contiguous)(size_t size, size_t count);
+    void (*free)(void* block);
+    void (*free_batch)(void** blocks, size_t count);
+    void* (*resize)(void* block, size_t size);
+    int (*reserve)(size_t size);
+    void* (*pool_base)(void);
+    void (*deinit)(void);
+    // Optional. Hands free memory idle for decay_ns back to the OS, visiting
+    // at most max_blocks blocks from where the previous call stopped, and
+    // adds to stats. Returns the blocks visited; fewer than max_blocks means
+    // the pass reached the end of the pool.
+    size_t (*purge)(uint64_t decay_ns, size_t max_blocks, MemPurgeStats* stats);
+    // Optional. Free bytes currently handed back to the OS.
+    size_t (*released)(void);
+    // Optional. Like alloc but the block reads as zero; backends that know
+    // which free memory is still zero skip clearing it.
+    void* (*alloc_zeroed)(size_t size);
+    // Optional. Bytes usable in the allocated block that starts at ptr, or 0
+    // if no allocated block starts there. Lets mem_resize move a growing pool
+    // block into a large mapping.
+    size_t (*usable_size)(void* ptr);
+} MemBackend;
+
+// Monotonic time in nanoseconds, used for decay timestamps.
+static inline uint64_t mm_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+// Sampling heap profiler (mm_profile.c). The checks below run on every
+// allocation and free, so they only touch a thread-local countdown and a
+// counter of live samples; the rest happens out of line.
+extern atomic_size_t mm_profile_period;
+extern atomic_size_t mm_profile_live;
+extern __thread int64_t mm_profile_countdown;
+void mm_profile_sample(void* ptr, size_t size);
+void mm_profile_forget(void* ptr);
+void mm_profile_reset_live(void);
+void mm_profile_from_env(void);
+
+static inline void mm_profile_alloc(void* ptr, size_t size) {
+    if (atomic_load_explicit(&mm_profile_period, memory_order_relaxed) != 0 && ptr != NULL &&
+        (mm_profile_countdown -= (int64_t) size) < 0) {
+        mm_profile_sample(ptr, size);
+    }
+}
+
+static inline void mm_profile_free(void* ptr) {
+    if (atomic_load_explicit(&mm_profile_live, memory_order_relaxed) != 0) {
+        mm_profile_forget(ptr);
+    }
+}
+
+// File-backed and shared pools are TLSF pools whose whole state lives in
+// the mapping (mm_tlsf.c). Same return values as mem_init_file and
+// mem_init_shared.
+int tlsf_init_file(const char* path, size_t size);
+int tlsf_init_shared(const char* name, size_t size);
+int tlsf_set_root(void* ptr);
+void* tlsf_root(void);
+
+extern const MemBackend mm_firstfit_backend;  // mm_firstfit.c
+extern const MemBackend mm_bestfit_backend;   // mm_firstfit.c
+extern const MemBackend mm_buddy_backend;     // mm_buddy.c
+extern const MemBackend mm_tlsf_backend;      // mm_tlsf.c
+
+#endif // MM_BACKEND_H
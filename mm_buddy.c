@@ -0,0 +1,522 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "mm_backend.h"
+
+// Binärt buddysystem bakom samma gränssnitt som first-fit-poolen i mm_firstfit.c.
+// Varje block är 2^k byte och börjar på en förskjutning delbar med sin storlek, så ett
+// blocks buddy hittas med en xor. Delning och sammanslagning tar O(log n) steg.
+// Tillståndet ligger i två bitkartor utanför poolen: en bit per (ordning, blockindex)
+// för lediga block och en för allokerade. Lediga block länkas ihop i sin egen nyttolast.
+
+#define BUDDY_MIN_ORDER 4                        // 16 byte, plats för länkarna i ett ledigt block
+#define BUDDY_MAX_ORDERS 64
+#define BUDDY_DEFAULT_MAX ((size_t) 1 << 30)     // Reservation när mem_init_growable saknar gräns
+#define BLOCK_SIZE(order) ((size_t) 1 << (order))
+
+typedef struct FreeBlock {
+    struct FreeBlock* next;
+    struct FreeBlock* prev;
+} FreeBlock;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static char* pool_start = NULL;
+static size_t pool_size = 0;       // Byte i bruk, multipel av den minsta blockstorleken
+static size_t pool_reserved = 0;   // Reserverad adressrymd, poolen kan växa upp till den
+static int pool_growable = 0;
+static int max_order = 0;          // Största ordning som får plats i reservationen
+
+static FreeBlock* free_lists[BUDDY_MAX_ORDERS];
+static uint64_t* free_map = NULL;
+static uint64_t* alloc_map = NULL;
+static size_t map_offset[BUDDY_MAX_ORDERS];  // Första ordet för varje ordning i kartorna
+static size_t map_bytes = 0;
+
+static size_t round_to_page(size_t size) {
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    return (size + page - 1) / page * page;
+}
+
+// ---- Bitkartor ----
+
+static inline int test_bit(const uint64_t* map, int order, size_t offset) {
+    size_t index = offset >> order;
+    return (map[map_offset[order] + (index >> 6)] >> (index & 63)) & 1;
+}
+
+static inline void set_bit(uint64_t* map, int order, size_t offset) {
+    size_t index = offset >> order;
+    map[map_offset[order] + (index >> 6)] |= (uint64_t) 1 << (index & 63);
+}
+
+static inline void clear_bit(uint64_t* map, int order, size_t offset) {
+    size_t index = offset >> order;
+    map[map_offset[order] + (index >> 6)] &= ~((uint64_t) 1 << (index & 63));
+}
+
+// ---- Listor av lediga block, en per ordning ----
+
+static void push_free(int order, size_t offset) {
+    FreeBlock* block = (FreeBlock*) (pool_start + offset);
+    block->prev = NULL;
+    block->next = free_lists[order];
+    if (block->next != NULL) {
+        block->next->prev = block;
+    }
+    free_lists[order] = block;
+    set_bit(free_map, order, offset);
+}
+
+static void remove_free(int order, size_t offset) {
+    FreeBlock* block = (FreeBlock*) (pool_start + offset);
+    if (block->prev != NULL) {
+        block->prev->next = block->next;
+    } else {
+        free_lists[order] = block->next;
+    }
+    if (block->next != NULL) {
+        block->next->prev = block->prev;
+    }
+    clear_bit(free_map, order, offset);
+}
+
+// Lämna tillbaka ett block och slå ihop det med sin buddy så länge den också är ledig
+static void release_block(size_t offset, int order) {
+    while (order < max_order) {
+        size_t buddy = offset ^ BLOCK_SIZE(order);
+        if (buddy + BLOCK_SIZE(order) > pool_size || !test_bit(free_map, order, buddy)) {
+            break;
+        }
+        remove_free(order, buddy);
+        offset &= ~BLOCK_SIZE(order);
+        order++;
+    }
+    push_free(order, offset);
+}
+
+// Dela upp [from, to) i de största block som passar och lämna dem som lediga
+static void add_range(size_t from, size_t to) {
+    size_t offset = from;
+    while (offset + BLOCK_SIZE(BUDDY_MIN_ORDER) <= to) {
+        int order = max_order;
+        while (order > BUDDY_MIN_ORDER &&
+               ((offset & (BLOCK_SIZE(order) - 1)) != 0 || offset + BLOCK_SIZE(order) > to)) {
+            order--;
+        }
+        release_block(offset, order);
+        offset += BLOCK_SIZE(order);
+    }
+}
+
+// Ordningen för ett block som rymmer size byte, -1 om det är större än reservationen
+static int order_for(size_t size) {
+    int order = BUDDY_MIN_ORDER;
+    while (order <= max_order && BLOCK_SIZE(order) < size) {
+        order++;
+    }
+    return order <= max_order ? order : -1;
+}
+
+// ---- Poolen ----
+
+static void release_pool(void) {
+    if (pool_start != NULL) {
+        munmap(pool_start, pool_reserved);
+    }
+    if (free_map != NULL) {
+        munmap(free_map, map_bytes);
+    }
+    pool_start = NULL;
+    free_map = NULL;
+    alloc_map = NULL;
+    pool_size = 0;
+    pool_reserved = 0;
+    pool_growable = 0;
+    map_bytes = 0;
+    memset(free_lists, 0, sizeof(free_lists));
+}
+
+// Reservera adressrymd och bitkartor för 'reserved' byte och ta 'committed' i bruk
+static void setup_pool(size_t committed, size_t reserved, int growable) {
+    release_pool();
+
+    max_order = BUDDY_MIN_ORDER;
+    while (max_order + 1 < BUDDY_MAX_ORDERS && BLOCK_SIZE(max_order + 1) <= reserved) {
+        max_order++;
+    }
+
+    // Kartorna är lika stora som reservationen kräver, men bara använda sidor kostar minne
+    size_t words = 0;
+    for (int order = BUDDY_MIN_ORDER; order <= max_order; order++) {
+        map_offset[order] = words;
+        words += ((reserved >> order) + 1 + 63) / 64;
+    }
+    map_bytes = round_to_page(2 * words * sizeof(uint64_t));
+    void* maps = mmap(NULL, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    void* base = mmap(NULL, reserved, growable ? PROT_NONE : PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (maps == MAP_FAILED || base == MAP_FAILED) {
+        perror("Misslyckades med att allokera minnespool");
+        exit(EXIT_FAILURE);
+    }
+    if (growable && mprotect(base, committed, PROT_READ | PROT_WRITE) != 0) {
+        perror("Misslyckades med att allokera minnespool");
+        exit(EXIT_FAILURE);
+    }
+
+    free_map = (uint64_t*) maps;
+    alloc_map = free_map + words;
+    pool_start = (char*) base;
+    pool_reserved = reserved;
+    pool_growable = growable;
+    // Avrunda uppåt till hela minsta block, reservationen är alltid hela sidor
+    pool_size = (committed + BLOCK_SIZE(BUDDY_MIN_ORDER) - 1) & ~(BLOCK_SIZE(BUDDY_MIN_ORDER) - 1);
+    add_range(0, pool_size);
+}
+
+// Fördubbla poolen inom reservationen, det nya området slås ihop med lediga block före det
+static int grow_pool(void) {
+    if (!pool_growable || pool_size == pool_reserved) {
+        return -1;
+    }
+    size_t new_size = round_to_page(pool_size * 2);
+    if (new_size > pool_reserved) {
+        new_size = pool_reserved;
+    }
+    if (mprotect(pool_start + pool_size, new_size - pool_size, PROT_READ | PROT_WRITE) != 0) {
+        return -1;
+    }
+    size_t old_size = pool_size;
+    pool_size = new_size;
+    add_range(old_size, new_size);
+    return 0;
+}
+
+static void buddy_init(size_t size) {
+    pthread_mutex_lock(&pool_lock);
+    setup_pool(size, round_to_page(size ? size : 1), 0);
+    pthread_mutex_unlock(&pool_lock);
+}
+
+static void buddy_init_growable(size_t initial_size, size_t max_size) {
+    pthread_mutex_lock(&pool_lock);
+    size_t reserved = round_to_page(max_size ? max_size : BUDDY_DEFAULT_MAX);
+    size_t committed = round_to_page(initial_size ? initial_size : 1);
+    if (reserved < committed) {
+        reserved = committed;
+    }
+    setup_pool(committed, reserved, 1);
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// ---- Allokering ----
+
+// Ta ett block av given ordning, dela ett större om det behövs. Anropas med låset taget.
+static void* alloc_order(int order) {
+    int k = order;
+    while (k <= max_order && free_lists[k] == NULL) {
+        k++;
+    }
+    if (k > max_order) {
+        return NULL;
+    }
+
+    size_t offset = (size_t) ((char*) free_lists[k] - pool_start);
+    remove_free(k, offset);
+    while (k > order) {
+        k--;
+        push_free(k, offset + BLOCK_SIZE(k));  // Den övre halvan blir ledig
+    }
+    set_bit(alloc_map, order, offset);
+    return pool_start + offset;
+}
+
+static void* alloc_locked(size_t size) {
+    int order = order_for(size);
+    if (order < 0 || pool_start == NULL) {
+        return NULL;
+    }
+    void* ptr;
+    while ((ptr = alloc_order(order)) == NULL && grow_pool() == 0) {
+        // Försök igen i den större poolen
+    }
+    return ptr;
+}
+
+static void* buddy_alloc(size_t size) {
+    pthread_mutex_lock(&pool_lock);
+    void* ptr = NULL;
+    if (size == 0) {
+        // Reservera ingenting, returnera adressen som nästa minsta allokering skulle få
+        for (int k = BUDDY_MIN_ORDER; k <= max_order && pool_start != NULL; k++) {
+            if (free_lists[k] != NULL) {
+                ptr = free_lists[k];
+                break;
+            }
+        }
+    } else {
+        ptr = alloc_locked(size);
+    }
+    pthread_mutex_unlock(&pool_lock);
+    return ptr;
+}
+
+// Ordningen på blocket som börjar på offset, och om det är ledigt
+static int block_at(size_t offset, int* is_free) {
+    for (int order = max_order; order >= BUDDY_MIN_ORDER; order--) {
+        if ((offset & (BLOCK_SIZE(order) - 1)) != 0 || offset + BLOCK_SIZE(order) > pool_size) {
+            continue;
+        }
+        if (test_bit(free_map, order, offset)) {
+            *is_free = 1;
+            return order;
+        }
+        if (test_bit(alloc_map, order, offset)) {
+            *is_free = 0;
+            return order;
+        }
+    }
+    *is_free = 0;
+    return BUDDY_MIN_ORDER;
+}
+
+// Förskjutning där length lediga byte följer efter varandra, justerad till align.
+// Oftast räcker ett enda ledigt block av den ordning som täcker intervallet, det tas
+// ur frilistorna. Blocket börjar på en multipel av sin storlek och därmed av align.
+// Bara när inget sådant block finns letas en följd av mindre grannblock upp linjärt.
+static size_t find_free_range(size_t length, size_t align) {
+    int cover = order_for(length);
+    for (int k = cover; k >= 0 && k <= max_order; k++) {
+        if (free_lists[k] != NULL) {
+            return (size_t) ((char*) free_lists[k] - pool_start);
+        }
+    }
+
+    size_t offset = 0;
+    size_t run_start = SIZE_MAX;
+    while (offset < pool_size) {
+        int is_free;
+        size_t end = offset + BLOCK_SIZE(block_at(offset, &is_free));
+        if (!is_free) {
+            run_start = SIZE_MAX;
+        } else if (run_start == SIZE_MAX) {
+            size_t aligned = (offset + align - 1) & ~(align - 1);
+            run_start = aligned < end ? aligned : SIZE_MAX;
+        }
+        if (run_start != SIZE_MAX && end - run_start >= length) {
+            return run_start;
+        }
+        offset = end;
+    }
+    return SIZE_MAX;
+}
+
+// Dela ett ledigt block så att [start, end) blir allokerade block av unit_order,
+// delarna utanför intervallet blir lediga
+static void carve(size_t offset, int order, size_t start, size_t end, int unit_order) {
+    size_t block_end = offset + BLOCK_SIZE(order);
+    if (block_end <= start || offset >= end) {
+        push_free(order, offset);  // Buddyn är delvis allokerad, så ingen sammanslagning
+        return;
+    }
+    if (offset >= start && block_end <= end && order <= unit_order) {
+        set_bit(alloc_map, order, offset);
+        return;
+    }
+    carve(offset, order - 1, start, end, unit_order);
+    carve(offset + BLOCK_SIZE(order - 1), order - 1, start, end, unit_order);
+}
+
+static void* buddy_alloc_contiguous(size_t size, size_t count) {
+    if (size == 0 || count == 0 || count > SIZE_MAX / size) {
+        return NULL;
+    }
+
+    if (count == 1) {
+        return buddy_alloc(size);
+    }
+    // Element som inte själva kan vara buddyblock kan inte frigöras ett och ett
+    if ((size & (size - 1)) != 0 || size < BLOCK_SIZE(BUDDY_MIN_ORDER)) {
+        return NULL;
+    }
+
+    // Varje element blir ett eget block, så de kan frigöras ett och ett
+    pthread_mutex_lock(&pool_lock);
+    size_t length = size * count;
+    int unit_order = order_for(size);
+    size_t start = SIZE_MAX;
+    while (unit_order >= 0 && pool_start != NULL &&
+           (start = find_free_range(length, size)) == SIZE_MAX && grow_pool() == 0) {
+        // Försök igen i den större poolen
+    }
+    if (start == SIZE_MAX || unit_order < 0) {
+        pthread_mutex_unlock(&pool_lock);
+        return NULL;
+    }
+
+    // Första lediga blocket som täcker början av intervallet
+    int order = BUDDY_MIN_ORDER;
+    size_t offset = start;
+    while (!test_bit(free_map, order, offset)) {
+        order++;
+        offset = start & ~(BLOCK_SIZE(order) - 1);
+    }
+    size_t end = start + length;
+    while (offset < end) {
+        remove_free(order, offset);
+        carve(offset, order, start, end, unit_order);
+        offset += BLOCK_SIZE(order);
+        if (offset < end) {
+            int is_free;
+            order = block_at(offset, &is_free);
+        }
+    }
+    pthread_mutex_unlock(&pool_lock);
+    return pool_start + start;
+}
+
+// ---- Frigöring ----
+
+// Ordningen på det allokerade block som börjar på offset, -1 om inget gör det
+static int allocated_order(size_t offset) {
+    for (int order = BUDDY_MIN_ORDER; order <= max_order; order++) {
+        if ((offset & (BLOCK_SIZE(order) - 1)) != 0 || offset + BLOCK_SIZE(order) > pool_size) {
+            break;
+        }
+        if (test_bit(alloc_map, order, offset)) {
+            return order;
+        }
+    }
+    return -1;
+}
+
+// Ligger offset inne i ett ledigt block?
+static int inside_free_block(size_t offset) {
+    for (int order = BUDDY_MIN_ORDER; order <= max_order; order++) {
+        size_t start = offset & ~(BLOCK_SIZE(order) - 1);
+        if (start + BLOCK_SIZE(order) <= pool_size && test_bit(free_map, order, start)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void free_locked(void* ptr) {
+    if (!ptr) {
+        mem_report(MEM_ERR_NULL_FREE, NULL);
+        return;
+    }
+    char* p = (char*) ptr;
+    if (pool_start == NULL || p < pool_start || p >= pool_start + pool_size) {
+        mem_report(MEM_ERR_FOREIGN_POINTER, ptr);
+        return;
+    }
+
+    size_t offset = (size_t) (p - pool_start);
+    int order = allocated_order(offset);
+    if (order < 0) {
+        if (inside_free_block(offset)) {
+            mem_report(MEM_ERR_DOUBLE_FREE, ptr);
+        } else {
+            mem_report(MEM_ERR_FOREIGN_POINTER, ptr);
+        }
+        return;
+    }
+    clear_bit(alloc_map, order, offset);
+    release_block(offset, order);
+}
+
+static void buddy_free(void* ptr) {
+    pthread_mutex_lock(&pool_lock);
+    free_locked(ptr);
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// Buddyblock slås ihop direkt vid frigöring, så en batch behöver bara ta låset en gång
+static void buddy_free_batch(void** ptrs, size_t count) {
+    pthread_mutex_lock(&pool_lock);
+    for (size_t i = 0; i < count; i++) {
+        free_locked(ptrs[i]);
+    }
+    pthread_mutex_unlock(&pool_lock);
+}
+
+static void* buddy_resize(void* ptr, size_t size) {
+    if (!ptr) return buddy_alloc(size); // Om pekaren är NULL, allokera nytt minne
+
+    pthread_mutex_lock(&pool_lock);
+    char* p = (char*) ptr;
+    int order = -1;
+    if (pool_start != NULL && p >= pool_start && p < pool_start + pool_size) {
+        order = allocated_order((size_t) (p - pool_start));
+    }
+    if (order < 0) {
+        pthread_mutex_unlock(&pool_lock);
+        mem_report(MEM_ERR_RESIZE_UNKNOWN, ptr);
+        return NULL;
+    }
+
+    void* new_ptr = ptr;  // Blocket räcker redan till
+    if (BLOCK_SIZE(order) < size) {
+        new_ptr = alloc_locked(size);
+        if (new_ptr) {
+            memcpy(new_ptr, ptr, BLOCK_SIZE(order));
+            free_locked(ptr);
+        }
+    }
+    pthread_mutex_unlock(&pool_lock);
+    return new_ptr;
+}
+
+// Se till att en allokering av 'size' byte lyckas utan att poolen behöver växa
+static int buddy_reserve(size_t size) {
+    pthread_mutex_lock(&pool_lock);
+    int order = order_for(size ? size : 1);
+    int result = -1;
+    while (order >= 0 && pool_start != NULL) {
+        int k = order;
+        while (k <= max_order && free_lists[k] == NULL) {
+            k++;
+        }
+        if (k <= max_order) {
+            result = 0;
+            break;
+        }
+        if (grow_pool() != 0) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pool_lock);
+    return result;
+}
+
+static size_t buddy_usable_size(void* ptr) {
+    pthread_mutex_lock(&pool_lock);
+    char* p = (char*) ptr;
+    int order = -1;
+    if (pool_start != NULL && p >= pool_start && p < pool_start + pool_size) {
+        order = allocated_order((size_t) (p - pool_start));
+    }
+    pthread_mutex_unlock(&pool_lock);
+    return order < 0 ? 0 : BLOCK_SIZE(order);
+}
+
+static void* buddy_pool_base(void) {
+    return pool_start;
+}
+
+static void buddy_deinit(void) {
+    pthread_mutex_lock(&pool_lock);
+    release_pool();
+    pthread_mutex_unlock(&pool_lock);
+}
+
+const MemBackend mm_buddy_backend = {
+    "buddy", buddy_init, buddy_init_growable, buddy_alloc, buddy_alloc_contiguous, buddy_free,
+    buddy_free_batch, buddy_resize, buddy_reserve, buddy_pool_base, buddy_deinit, NULL, NULL, NULL,
+    buddy_usable_size
+};
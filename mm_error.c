@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include "mm_backend.h"
+
+// Fel från minneshanteraren och listorna rapporteras utan lås: en räknare per felkod,
+// en ringbuffert med de senaste händelserna och en valfri återanropsfunktion.
+// Utskriften till stderr begränsas till ett antal rader per sekund och görs med ett
+// enda write per rad, utan stdio och dess lås. Den sker på den rapporterande tråden,
+// ofta med poolens lås taget, så en skur av fel varken köar trådarna eller dränker loggarna.
+
+#define MEM_EVENT_RING 256                 // Tvåpotens, index tas modulo storleken
+#define MEM_ERROR_OUTPUT_DEFAULT 10        // Rader per sekund om inget annat anges
+
+static const char* const error_messages[MEM_ERROR_COUNT] = {
+    [MEM_OK] = "Inget fel",
+    [MEM_ERR_NULL_FREE] = "Försökte frigöra en NULL-pekare",
+    [MEM_ERR_DOUBLE_FREE] = "Blocket är redan fritt",
+    [MEM_ERR_FOREIGN_POINTER] = "Pekaren var inte allokerad från denna pool",
+    [MEM_ERR_RESIZE_UNKNOWN] = "Ändring av storlek misslyckades, pekaren hittades inte",
+    [MEM_ERR_OUT_OF_MEMORY] = "Minnesallokering misslyckades",
+    [MEM_ERR_NULL_NODE] = "Noden får inte vara NULL",
+    [MEM_ERR_NODE_NOT_IN_LIST] = "Den angivna noden finns inte i listan",
+    [MEM_ERR_LIST_EMPTY] = "Listan är tom",
+    [MEM_ERR_DATA_NOT_FOUND] = "Data hittades inte i listan",
+    [MEM_ERR_POOL_CORRUPT] = "Poolen är skadad",
+    [MEM_ERR_UNKNOWN_BACKEND] = "Okänd allokeringsstrategi, använder firstfit",
+};
+
+static atomic_uint_fast64_t error_counts[MEM_ERROR_COUNT];
+
+// Varje plats har ett sekvensnummer: udda medan den skrivs, 2 * (index + 1) när den är klar.
+// En läsare som ser samma jämna nummer före och efter kopian har fått en hel händelse.
+typedef struct EventSlot {
+    atomic_uint_fast64_t sequence;
+    atomic_int code;
+    atomic_uintptr_t ptr;
+    atomic_uint_fast64_t time_ns;
+} EventSlot;
+
+static EventSlot event_ring[MEM_EVENT_RING];
+static atomic_uint_fast64_t event_head = 0;
+
+typedef struct ErrorHook {
+    MemErrorCallback fn;
+    void* ctx;
+} ErrorHook;
+
+static _Atomic(ErrorHook*) error_hook = NULL;
+
+static atomic_int output_limit = MEM_ERROR_OUTPUT_DEFAULT;
+static atomic_uint_fast64_t output_second = 0;
+static atomic_int output_used = 0;
+static atomic_uint_fast64_t output_suppressed = 0;
+
+static _Thread_local MemError last_error = MEM_OK;
+
+const char* mem_error_string(MemError code) {
+    if ((int) code < 0 || code >= MEM_ERROR_COUNT) {
+        return "Okänt fel";
+    }
+    return error_messages[code];
+}
+
+static void record_event(MemError code, const void* ptr, uint64_t now) {
+    uint64_t index = atomic_fetch_add_explicit(&event_head, 1, memory_order_relaxed);
+    EventSlot* slot = &event_ring[index & (MEM_EVENT_RING - 1)];
+    atomic_store_explicit(&slot->sequence, 2 * index + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&slot->code, (int) code, memory_order_relaxed);
+    atomic_store_explicit(&slot->ptr, (uintptr_t) ptr, memory_order_relaxed);
+    atomic_store_explicit(&slot->time_ns, now, memory_order_relaxed);
+    atomic_store_explicit(&slot->sequence, 2 * (index + 1), memory_order_release);
+}
+
+// Hela raden i ett anrop, så rader från olika trådar inte blandas ihop
+static void write_line(const char* line, int length, size_t cap) {
+    if (length > 0) {
+        ssize_t ignored = write(STDERR_FILENO, line, (size_t) length < cap ? (size_t) length : cap - 1);
+        (void) ignored;
+    }
+}
+
+// Högst output_limit rader per sekund, resten räknas och sammanfattas i nästa sekund
+static void print_event(MemError code, const void* ptr, uint64_t now) {
+    int limit = atomic_load_explicit(&output_limit, memory_order_relaxed);
+    if (limit <= 0) {
+        return;
+    }
+    uint64_t second = now / 1000000000u;
+    uint64_t current = atomic_load_explicit(&output_second, memory_order_relaxed);
+    if (second != current &&
+        atomic_compare_exchange_strong_explicit(&output_second, &current, second,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        atomic_store_explicit(&output_used, 0, memory_order_relaxed);
+        uint64_t suppressed = atomic_exchange_explicit(&output_suppressed, 0, memory_order_relaxed);
+        if (suppressed > 0) {
+            char line[96];
+            int length = snprintf(line, sizeof(line), "Varning: %llu meddelanden undertrycktes.\n",
+                                  (unsigned long long) suppressed);
+            write_line(line, length, sizeof(line));
+        }
+    }
+    if (atomic_fetch_add_explicit(&output_used, 1, memory_order_relaxed) >= limit) {
+        atomic_fetch_add_explicit(&output_suppressed, 1, memory_order_relaxed);
+        return;
+    }
+    char line[160];
+    int length = ptr != NULL ? snprintf(line, sizeof(line), "Varning: %s (%p).\n", error_messages[code], ptr)
+                             : snprintf(line, sizeof(line), "Varning: %s.\n", error_messages[code]);
+    write_line(line, length, sizeof(line));
+}
+
+void mem_report(MemError code, const void* ptr) {
+    if ((int) code <= MEM_OK || code >= MEM_ERROR_COUNT) {
+        return;
+    }
+    uint64_t now = mm_now_ns();
+    last_error = code;
+    atomic_fetch_add_explicit(&error_counts[code], 1, memory_order_relaxed);
+    record_event(code, ptr, now);
+
+    ErrorHook* hook = atomic_load_explicit(&error_hook, memory_order_acquire);
+    if (hook != NULL) {
+        MemEvent event = { code, ptr, now };
+        hook->fn(&event, hook->ctx);
+    }
+    print_event(code, ptr, now);
+}
+
+MemError mem_last_error(void) {
+    return last_error;
+}
+
+uint64_t mem_error_count(MemError code) {
+    if ((int) code < 0 || code >= MEM_ERROR_COUNT) {
+        return 0;
+    }
+    return atomic_load_explicit(&error_counts[code], memory_order_relaxed);
+}
+
+void mem_reset_errors(void) {
+    for (int code = 0; code < MEM_ERROR_COUNT; code++) {
+        atomic_store_explicit(&error_counts[code], 0, memory_order_relaxed);
+    }
+    last_error = MEM_OK;
+}
+
+// Kopiera de senaste händelserna, äldst först. Platser som skrivs om under kopian hoppas över.
+size_t mem_recent_errors(MemEvent* events, size_t max) {
+    uint64_t head = atomic_load_explicit(&event_head, memory_order_acquire);
+    uint64_t first = head > MEM_EVENT_RING ? head - MEM_EVENT_RING : 0;
+    if (head - first > max) {
+        first = head - max;
+    }
+
+    size_t copied = 0;
+    for (uint64_t index = first; index < head; index++) {
+        EventSlot* slot = &event_ring[index & (MEM_EVENT_RING - 1)];
+        uint64_t before = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        MemEvent event;
+        event.code = (MemError) atomic_load_explicit(&slot->code, memory_order_relaxed);
+        event.ptr = (const void*) atomic_load_explicit(&slot->ptr, memory_order_relaxed);
+        event.time_ns = atomic_load_explicit(&slot->time_ns, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t after = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+        if (before == 2 * (index + 1) && after == before) {
+            events[copied++] = event;
+        }
+    }
+    return copied;
+}
+
+// Den gamla kroken frigörs aldrig, en tråd kan fortfarande vara mitt i ett anrop till den
+void mem_set_error_callback(MemErrorCallback fn, void* ctx) {
+    ErrorHook* hook = NULL;
+    if (fn != NULL) {
+        hook = (ErrorHook*) malloc(sizeof(ErrorHook));
+        if (!hook) {
+            return;
+        }
+        hook->fn = fn;
+        hook->ctx = ctx;
+    }
+    atomic_store_explicit(&error_hook, hook, memory_order_release);
+}
+
+// En ny gräns börjar med ett tomt fönster
+void mem_set_error_output(int lines_per_second) {
+    atomic_store_explicit(&output_limit, lines_per_second, memory_order_relaxed);
+    atomic_store_explicit(&output_used, 0, memory_order_relaxed);
+}
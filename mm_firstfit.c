@@ -0,0 +1,746 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "mm_backend.h"
+
+// Den ursprungliga poolen: en länkad lista av blockmetadata som söks igenom från början.
+// Samma kod ger två strategier, first-fit och best-fit, som bara skiljer sig i sökningen.
+
+typedef struct MemBlock {
+    size_t block_size;           
+    int is_available;            
+    struct MemBlock* next_block; 
+    void* data_ptr;              
+    size_t unit_size;            // >0 för en sammanhängande körning av lika stora element (mem_alloc_contiguous)
+    uint64_t freed_at;           // När ett ledigt block senast frigjordes, i nanosekunder
+    size_t released;             // Byte av ett ledigt block som är lämnade tillbaka till systemet
+} MemBlock;
+
+
+static void* pool_start = NULL;
+static MemBlock* pool_head = NULL;
+static size_t total_pool_size = 0;
+
+// Med best-fit väljs det minsta lediga block som räcker i stället för det första
+static int best_fit = 0;
+
+// Ett lås skyddar blocklistan så att flera trådar kan allokera och frigöra samtidigt.
+// De interna hjälpfunktionerna förutsätter att låset redan är taget.
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// En växande pool reserverar adressrymd i förväg och tar den i bruk bit för bit,
+// så poolen flyttas aldrig och pekare in i den förblir giltiga. 0 för en fast pool.
+static size_t pool_reserved = 0;
+
+// Adressrymd som reserveras när mem_init_growable inte får någon övre gräns
+#define MEM_GROWABLE_DEFAULT_MAX ((size_t) 1 << 30)
+
+// Varje block börjar på en adress som duger för alla typer. Storlekar avrundas uppåt, utom när
+// resten av ett ledigt block räcker exakt, så att en pool som fylls helt fortfarande går att fylla.
+#define FF_ALIGN _Alignof(max_align_t)
+
+// Lediga byte som är lämnade tillbaka med madvise och inte har använts igen
+static size_t released_bytes = 0;
+// Blocket där nästa steg av en rensning börjar, NULL betyder från början av poolen.
+// Slås blocket ihop med föregående flyttas markören dit, så den pekar aldrig på frigjord metadata.
+static MemBlock* purge_cursor = NULL;
+
+static size_t round_to_page(size_t size) {
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    return (size + page - 1) / page * page;
+}
+
+// Hela sidor inuti blocket, bara de kan lämnas tillbaka till systemet
+static size_t purgeable_length(const MemBlock* block, char** start) {
+    uintptr_t page = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t first = ((uintptr_t) block->data_ptr + page - 1) & ~(page - 1);
+    uintptr_t end = ((uintptr_t) block->data_ptr + block->block_size) & ~(page - 1);
+    if (start != NULL) {
+        *start = (char*) first;
+    }
+    return end > first ? end - first : 0;
+}
+
+// Nya sidor från systemet är ännu inte i bruk och räknas som redan tillbakalämnade
+static void init_free_block(MemBlock* block) {
+    block->is_available = 1;
+    block->unit_size = 0;
+    block->freed_at = mm_now_ns();
+    block->released = purgeable_length(block, NULL);
+    released_bytes += block->released;
+}
+
+static void mark_freed(MemBlock* block, uint64_t now) {
+    block->is_available = 1;
+    block->freed_at = now;
+    block->released = 0;
+}
+
+// Slå ihop ett ledigt block med nästa, den sammanslagna delen räknas som nyss frigjord
+static void absorb_next(MemBlock* block) {
+    MemBlock* next = block->next_block;
+    block->block_size += next->block_size;
+    block->next_block = next->next_block;
+    block->released += next->released;
+    if (next->freed_at > block->freed_at) {
+        block->freed_at = next->freed_at;
+    }
+    if (purge_cursor == next) {
+        purge_cursor = block;
+    }
+    free(next);
+}
+
+
+static void ff_init(size_t pool_size) {
+    pthread_mutex_lock(&pool_lock);
+    best_fit = 0;
+
+    // Allokera minne för hela minnespoolen. Nya sidor från mmap är nollställda,
+    // vilket mem_calloc utnyttjar.
+    pool_start = mmap(NULL, round_to_page(pool_size ? pool_size : 1), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pool_start == MAP_FAILED) {
+        perror("Misslyckades med att allokera minnespool");
+        exit(EXIT_FAILURE);
+    }
+
+    total_pool_size = pool_size;
+    pool_reserved = 0;
+    purge_cursor = NULL;
+
+    // Skapa det första minnesblocket som täcker hela poolen
+    pool_head = (MemBlock*)malloc(sizeof(MemBlock));
+    if (!pool_head) {
+        perror("Misslyckades med att skapa blockmetadata");
+        munmap(pool_start, round_to_page(pool_size ? pool_size : 1));
+        exit(EXIT_FAILURE);
+    }
+
+    // Initialisera det första blocket som ledigt och täcker hela poolen
+    pool_head->block_size = pool_size;
+    pool_head->data_ptr = pool_start;   // Peka på startadressen av minnespoolen
+    pool_head->next_block = NULL;       // Inget nästa block än
+    init_free_block(pool_head);         // Markera blocket som tillgängligt
+
+    pthread_mutex_unlock(&pool_lock);
+}
+
+static void ff_init_growable(size_t initial_size, size_t max_size) {
+    pthread_mutex_lock(&pool_lock);
+    best_fit = 0;
+
+    size_t reserved = round_to_page(max_size ? max_size : MEM_GROWABLE_DEFAULT_MAX);
+    size_t committed = round_to_page(initial_size ? initial_size : 1);
+    if (reserved < committed) {
+        reserved = committed;
+    }
+
+    // Reservera hela adressrymden utan åtkomst, bara den första delen tas i bruk
+    void* base = mmap(NULL, reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        perror("Misslyckades med att reservera minnespool");
+        exit(EXIT_FAILURE);
+    }
+    if (mprotect(base, committed, PROT_READ | PROT_WRITE) != 0) {
+        perror("Misslyckades med att allokera minnespool");
+        munmap(base, reserved);
+        exit(EXIT_FAILURE);
+    }
+
+    pool_head = (MemBlock*)malloc(sizeof(MemBlock));
+    if (!pool_head) {
+        perror("Misslyckades med att skapa blockmetadata");
+        munmap(base, reserved);
+        exit(EXIT_FAILURE);
+    }
+
+    pool_start = base;
+    total_pool_size = committed;
+    pool_reserved = reserved;
+    purge_cursor = NULL;
+
+    pool_head->block_size = committed;
+    pool_head->data_ptr = pool_start;
+    pool_head->next_block = NULL;
+    init_free_block(pool_head);
+
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// Ta mer av den reserverade adressrymden i bruk så att 'needed' byte ryms sist i poolen.
+// Poolen växer med minst sin nuvarande storlek, så antalet tillväxter blir logaritmiskt.
+// Anropas med låset taget, returnerar 0 om poolen växte.
+static int grow_pool(size_t needed) {
+    if (pool_reserved == 0) {
+        return -1;  // Fast pool
+    }
+
+    MemBlock* tail = pool_head;
+    while (tail->next_block != NULL) {
+        tail = tail->next_block;
+    }
+    size_t tail_free = tail->is_available ? tail->block_size : 0;
+    size_t missing = needed > tail_free ? needed - tail_free : 0;
+
+    size_t grow = round_to_page(missing > total_pool_size ? missing : total_pool_size);
+    if (grow > pool_reserved - total_pool_size) {
+        grow = pool_reserved - total_pool_size;
+    }
+    if (grow == 0 || grow < missing) {
+        return -1;  // Reservationen räcker inte
+    }
+
+    if (mprotect((char*)pool_start + total_pool_size, grow, PROT_READ | PROT_WRITE) != 0) {
+        return -1;
+    }
+
+    if (tail->is_available) {
+        tail->block_size += grow;
+        tail->released += grow;  // Poolens slut ligger alltid på en sidgräns
+        released_bytes += grow;
+    } else {
+        MemBlock* block = (MemBlock*)malloc(sizeof(MemBlock));
+        if (!block) {
+            mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);
+            return -1;  // Sidorna förblir i bruk och används vid nästa tillväxt
+        }
+        block->block_size = grow;
+        block->data_ptr = (char*)pool_start + total_pool_size;
+        block->next_block = NULL;
+        init_free_block(block);
+        tail->next_block = block;
+    }
+    total_pool_size += grow;
+    return 0;
+}
+
+static size_t round_to_align(size_t size) {
+    return (size + FF_ALIGN - 1) & ~(FF_ALIGN - 1);
+}
+
+// Byte i början av blocket som hoppas över för att nå en justerad adress. Bara block som
+// blir över när element i en körning frigörs kan börja ojusterat.
+static size_t align_pad(const MemBlock* block) {
+    return (FF_ALIGN - ((uintptr_t) block->data_ptr & (FF_ALIGN - 1))) & (FF_ALIGN - 1);
+}
+
+// Om ett ledigt block rymmer 'size' byte efter utfyllnaden, och i så fall hur många
+static int block_fits(const MemBlock* block, size_t size, size_t* usable) {
+    size_t pad = align_pad(block);
+    if (!block->is_available || block->block_size < pad || block->block_size - pad < size) {
+        return 0;
+    }
+    *usable = block->block_size - pad;
+    return 1;
+}
+
+// Första lediga block som räcker, eller med best-fit det minsta som räcker
+static MemBlock* find_fit(size_t size) {
+    MemBlock* best = NULL;
+    size_t best_size = 0;
+    size_t usable;
+    for (MemBlock* current = pool_head; current != NULL; current = current->next_block) {
+        if (block_fits(current, size, &usable)) {
+            if (!best_fit || usable == size) {
+                return current;
+            }
+            if (best == NULL || usable < best_size) {
+                best = current;
+                best_size = usable;
+            }
+        }
+    }
+    return best;
+}
+
+// Dela av 'size' byte från början av ett ledigt block och markera dem som upptagna
+static MemBlock* claim_block(MemBlock* current, size_t size) {
+    size_t pad = align_pad(current);
+    if (pad > 0) {
+        // Utfyllnaden blir ett eget litet ledigt block, den rymmer inga hela sidor
+        MemBlock* aligned = (MemBlock*)malloc(sizeof(MemBlock));
+        if (!aligned) {
+            mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);
+            return NULL;
+        }
+        aligned->block_size = current->block_size - pad;
+        aligned->is_available = 1;
+        aligned->data_ptr = (char*)current->data_ptr + pad;
+        aligned->next_block = current->next_block;
+        aligned->unit_size = 0;
+        aligned->freed_at = current->freed_at;
+        aligned->released = current->released;
+
+        current->block_size = pad;
+        current->next_block = aligned;
+        current->released = 0;
+        current = aligned;
+    }
+
+    // Resten av blocket tas hellre helt än att ett ojusterat block blir kvar
+    size_t rounded = round_to_align(size);
+    if (rounded <= current->block_size) {
+        size = rounded;
+    }
+
+    if (current->block_size > size) {
+        // Om blocket är större än behövligt, dela upp det i två block
+        MemBlock* new_block = (MemBlock*)malloc(sizeof(MemBlock));
+        if (!new_block) {
+            mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);
+            return NULL;
+        }
+
+        // Initiera det nya blocket med den återstående storleken
+        new_block->block_size = current->block_size - size;
+        new_block->is_available = 1; // Nya blocket är tillgängligt
+        new_block->data_ptr = (char*)current->data_ptr + size; // Justera datapekaren
+        new_block->next_block = current->next_block; // Länka till nästa block
+        new_block->unit_size = 0;
+
+        // Tillbakalämnade sidor i början av blocket tas i bruk igen, resten behålls
+        new_block->freed_at = current->freed_at;
+        size_t rest = current->released > size ? current->released - size : 0;
+        size_t length = purgeable_length(new_block, NULL);
+        new_block->released = rest < length ? rest : length;
+        released_bytes -= current->released - new_block->released;
+        current->released = 0;
+
+        // Uppdatera det aktuella blocket till den begärda storleken och markera det som upptaget
+        current->block_size = size;
+        current->is_available = 0; // Markera som upptaget
+        current->next_block = new_block; // Länka till det nya blocket
+    } else {
+        // Om blockets storlek exakt matchar den begärda storleken, markera det som upptaget
+        current->is_available = 0;
+        released_bytes -= current->released;
+        current->released = 0;
+    }
+
+    // Returnera blocket som nu är reserverat
+    return current;
+}
+
+// Hitta och reservera ett block, returnerar blockets metadata
+static MemBlock* alloc_block(size_t size) {
+    MemBlock* current = find_fit(size);
+    if (current != NULL) {
+        return claim_block(current, size);
+    }
+
+    // En växande pool tar mer minne i bruk och försöker igen
+    if (grow_pool(size + FF_ALIGN) == 0) {
+        return alloc_block(size);
+    }
+
+    // Returnera NULL om inget lämpligt block hittades
+    return NULL;
+}
+
+static void* ff_alloc(size_t size) {
+    pthread_mutex_lock(&pool_lock);
+    MemBlock* block = alloc_block(size);
+    pthread_mutex_unlock(&pool_lock);
+    return block ? block->data_ptr : NULL;
+}
+
+// Ett ledigt block vars hela sidor alla är tillbakalämnade är nollställt utom i kanterna,
+// så bara bitarna utanför sidorna behöver nollas
+static void* ff_alloc_zeroed(size_t size) {
+    pthread_mutex_lock(&pool_lock);
+    MemBlock* current = find_fit(size);
+    if (current == NULL && grow_pool(size + FF_ALIGN) == 0) {
+        current = find_fit(size);
+    }
+    if (current == NULL) {
+        pthread_mutex_unlock(&pool_lock);
+        return NULL;
+    }
+    char* zero_start;
+    size_t zero_length = purgeable_length(current, &zero_start);
+    if (current->released != zero_length) {
+        zero_length = 0;  // Okänt innehåll, allt nollas
+    }
+    MemBlock* block = claim_block(current, size);
+    pthread_mutex_unlock(&pool_lock);
+    if (block == NULL) {
+        return NULL;
+    }
+
+    // claim_block kan ha delat av utfyllnad i början, så sidorna begränsas till det tagna blocket
+    char* start = (char*)block->data_ptr;
+    char* end = start + size;
+    char* zero_end = zero_start + zero_length;
+    zero_start = zero_start < start ? start : zero_start > end ? end : zero_start;
+    zero_end = zero_end < zero_start ? zero_start : zero_end > end ? end : zero_end;
+    memset(start, 0, zero_start - start);
+    memset(zero_end, 0, end - zero_end);
+    return start;
+}
+
+static void* ff_alloc_contiguous(size_t size, size_t count) {
+    if (size == 0 || count == 0 || count > SIZE_MAX / size) {
+        return NULL;
+    }
+
+    // Hela körningen reserveras som ett enda block, så metadata kostar O(1) oavsett antal element
+    pthread_mutex_lock(&pool_lock);
+    MemBlock* block = alloc_block(size * count);
+    if (block && count > 1) {
+        block->unit_size = size;
+    }
+    pthread_mutex_unlock(&pool_lock);
+    return block ? block->data_ptr : NULL;
+}
+
+// Bryt ut 'length' byte (hela element) på 'offset' ur en körning så att de blir ett eget block.
+// Körningen delas i högst tre delar: före elementen, elementen och resten.
+static MemBlock* split_run(MemBlock* run, size_t offset, size_t length) {
+    if (offset > 0) {
+        MemBlock* tail = (MemBlock*)malloc(sizeof(MemBlock));
+        if (!tail) {
+            mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);
+            return NULL;
+        }
+        tail->block_size = run->block_size - offset;
+        tail->is_available = 0;
+        tail->data_ptr = (char*)run->data_ptr + offset;
+        tail->next_block = run->next_block;
+        tail->unit_size = run->unit_size;
+
+        run->block_size = offset;
+        run->next_block = tail;
+        run = tail;
+    }
+
+    // Körningen kan sluta med utfyllnad kortare än ett element, den följer med det sista
+    if (run->block_size - length >= run->unit_size) {
+        MemBlock* rest = (MemBlock*)malloc(sizeof(MemBlock));
+        if (!rest) {
+            mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);
+            return NULL;
+        }
+        rest->block_size = run->block_size - length;
+        rest->is_available = 0;
+        rest->data_ptr = (char*)run->data_ptr + length;
+        rest->next_block = run->next_block;
+        rest->unit_size = run->unit_size;
+
+        run->block_size = length;
+        run->next_block = rest;
+    }
+
+    run->unit_size = 0; // Elementen är nu ett vanligt block
+    return run;
+}
+
+// Leta upp blocket som hör till pekaren. Pekare in i en körning bryts ut till egna block.
+static MemBlock* find_block(void* ptr) {
+    MemBlock* current = pool_head;
+    while (current != NULL) {
+        if (current->unit_size == 0) {
+            if (current->data_ptr == ptr) {
+                return current;
+            }
+        } else if ((char*)ptr >= (char*)current->data_ptr &&
+                   (char*)ptr < (char*)current->data_ptr + current->block_size) {
+            size_t offset = (char*)ptr - (char*)current->data_ptr;
+            if (offset % current->unit_size != 0) {
+                return NULL; // Pekaren ligger mitt i ett element
+            }
+            return split_run(current, offset, current->unit_size);
+        }
+        current = current->next_block; // Gå vidare till nästa block i listan
+    }
+    return NULL;
+}
+
+// Frigör blocket för pekaren, anropas med låset taget
+static void free_block(void* ptr) {
+    MemBlock* current = find_block(ptr);
+    if (current != NULL) {
+        if (current->is_available) {
+            mem_report(MEM_ERR_DOUBLE_FREE, ptr);
+            return;
+        }
+
+        // Markera blocket som ledigt
+        mark_freed(current, mm_now_ns());
+
+        // Försök att slå samman med nästa block om det också är ledigt, för att undvika fragmentering
+        while (current->next_block != NULL && current->next_block->is_available) {
+            absorb_next(current);
+        }
+
+        return;
+    }
+
+    // Om pekaren inte hittas i poolen, ge en varning
+    mem_report(MEM_ERR_FOREIGN_POINTER, ptr);
+}
+
+static void ff_free(void* ptr) {
+    if (!ptr) {
+        mem_report(MEM_ERR_NULL_FREE, NULL);
+        return;
+    }
+
+    pthread_mutex_lock(&pool_lock);
+    free_block(ptr);
+    pthread_mutex_unlock(&pool_lock);
+}
+
+static int compare_pointers(const void* a, const void* b) {
+    uintptr_t pa = (uintptr_t) *(void* const*) a;
+    uintptr_t pb = (uintptr_t) *(void* const*) b;
+    return (pa > pb) - (pa < pb);
+}
+
+// Slå samman alla intilliggande lediga block i en enda genomgång
+static void coalesce_all(void) {
+    MemBlock* current = pool_head;
+    while (current != NULL) {
+        while (current->is_available && current->next_block != NULL && current->next_block->is_available) {
+            absorb_next(current);
+        }
+        current = current->next_block;
+    }
+}
+
+static void ff_free_batch(void** ptrs, size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    // Sortera pekarna i adressordning, då räcker en enda genomgång av blocklistan.
+    // Pekare som redan ligger i ordning (vanligt för listnoder) hoppar över sorteringen.
+    size_t i;
+    for (i = 1; i < count && (uintptr_t) ptrs[i - 1] <= (uintptr_t) ptrs[i]; i++) {
+    }
+    if (i < count) {
+        qsort(ptrs, count, sizeof(void*), compare_pointers);
+    }
+
+    pthread_mutex_lock(&pool_lock);
+    uint64_t now = mm_now_ns();
+    MemBlock* current = pool_head;
+    size_t j = 0;
+    while (current != NULL && j < count) {
+        char* start = (char*) current->data_ptr;
+        char* ptr = (char*) ptrs[j];
+
+        if (ptr == NULL) {
+            mem_report(MEM_ERR_NULL_FREE, NULL);
+            j++;
+            continue;
+        }
+        if (ptr < start) {
+            // Pekaren passerades utan att matcha något block
+            mem_report(MEM_ERR_FOREIGN_POINTER, ptr);
+            j++;
+            continue;
+        }
+
+        if (current->unit_size == 0) {
+            if (ptr == start) {
+                if (current->is_available) {
+                    mem_report(MEM_ERR_DOUBLE_FREE, ptr);
+                } else {
+                    mark_freed(current, now);
+                }
+                j++;
+                continue;
+            }
+            current = current->next_block;
+            continue;
+        }
+
+        // Pekare in i en körning: bryt ut varje sammanhängande följd av element på en gång
+        if (ptr >= start + current->block_size) {
+            current = current->next_block;
+            continue;
+        }
+        size_t offset = ptr - start;
+        if (offset % current->unit_size != 0) {
+            mem_report(MEM_ERR_FOREIGN_POINTER, ptr);
+            j++;
+            continue;
+        }
+        size_t length = current->unit_size;
+        size_t taken = 1;
+        while (j + taken < count && offset + length < current->block_size &&
+               (char*) ptrs[j + taken] == ptr + length) {
+            length += current->unit_size;
+            taken++;
+        }
+        MemBlock* freed = split_run(current, offset, length);
+        if (freed == NULL) {
+            break;  // Slut på minne för metadata, resten av pekarna rapporteras nedan
+        }
+        mark_freed(freed, now);
+        j += taken;
+        current = freed;
+    }
+    for (; j < count; j++) {
+        mem_report(MEM_ERR_FOREIGN_POINTER, ptrs[j]);
+    }
+
+    coalesce_all();
+    pthread_mutex_unlock(&pool_lock);
+}
+
+static void* ff_resize(void* ptr, size_t size) {
+    if (!ptr) return ff_alloc(size); // Om pekaren är NULL, allokera nytt minne
+
+    pthread_mutex_lock(&pool_lock);
+    MemBlock* block = find_block(ptr);
+    if (block != NULL) {
+        void* new_ptr = ptr; // Nuvarande block är tillräckligt stort, returnera samma pekare
+        if (block->block_size < size) {
+            // Allokera ett nytt block med den önskade storleken
+            MemBlock* new_block = alloc_block(size);
+            new_ptr = new_block ? new_block->data_ptr : NULL;
+            if (new_ptr) {
+                // Kopiera data från det gamla blocket till det nya
+                memcpy(new_ptr, ptr, block->block_size);
+                // Frigör det gamla blocket
+                free_block(ptr);
+            }
+        }
+        pthread_mutex_unlock(&pool_lock);
+        return new_ptr; // Returnera pekaren till det nya blocket eller NULL om allokering misslyckades
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    // Om pekaren inte hittas i poolen, ge en varning
+    mem_report(MEM_ERR_RESIZE_UNKNOWN, ptr);
+    return NULL;
+}
+
+// Se till att en allokering av 'size' byte lyckas utan att poolen behöver växa
+static int ff_reserve(size_t size) {
+    pthread_mutex_lock(&pool_lock);
+    MemBlock* current = find_fit(size);
+    int result = (current != NULL || grow_pool(size + FF_ALIGN) == 0) ? 0 : -1;
+    pthread_mutex_unlock(&pool_lock);
+    return result;
+}
+
+// Som find_block, men en pekare in i en körning ger elementets storlek utan att körningen delas
+static size_t ff_usable_size(void* ptr) {
+    size_t usable = 0;
+    pthread_mutex_lock(&pool_lock);
+    for (MemBlock* current = pool_head; current != NULL; current = current->next_block) {
+        if (current->unit_size == 0) {
+            if (current->data_ptr == ptr) {
+                usable = current->is_available ? 0 : current->block_size;
+                break;
+            }
+        } else if ((char*)ptr >= (char*)current->data_ptr &&
+                   (char*)ptr < (char*)current->data_ptr + current->block_size) {
+            size_t offset = (char*)ptr - (char*)current->data_ptr;
+            usable = offset % current->unit_size == 0 ? current->unit_size : 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pool_lock);
+    return usable;
+}
+
+// Poolens startadress, bas för strukturer som länkar med förskjutningar i stället för pekare
+static void* ff_pool_base(void) {
+    return pool_start;
+}
+
+// Funktion för att avinitiera minnespoolen och frigöra alla resurser
+static void ff_deinit(void) {
+    pthread_mutex_lock(&pool_lock);
+
+    if (pool_reserved > 0) {
+        munmap(pool_start, pool_reserved); // Hela reservationen lämnas tillbaka
+    } else if (pool_start != NULL) {
+        munmap(pool_start, round_to_page(total_pool_size ? total_pool_size : 1)); // Frigör hela minnespoolen
+    }
+    pool_start = NULL; // Sätt pool_start till NULL för att undvika hängande pekare
+
+    MemBlock* current = pool_head;
+    while (current != NULL) {
+        MemBlock* next = current->next_block; // Spara nästa block
+        free(current); // Frigör nuvarande blockmetadata
+        current = next; // Gå vidare till nästa block
+    }
+
+    pool_head = NULL;        // Sätt pool_head till NULL för att indikera att listan är tom
+    total_pool_size = 0;     // Återställ den totala poolstorleken till 0
+    pool_reserved = 0;
+    released_bytes = 0;
+    purge_cursor = NULL;
+
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// Lämna tillbaka sidorna i lediga block som inte har använts på decay_ns nanosekunder.
+// Varje anrop besöker högst max_blocks block med start där förra anropet slutade, så
+// låset hålls bara en kort stund. Returnerar antalet besökta block, färre än max_blocks
+// betyder att genomgången nådde slutet av poolen.
+static size_t ff_purge(uint64_t decay_ns, size_t max_blocks, MemPurgeStats* stats) {
+    pthread_mutex_lock(&pool_lock);
+    uint64_t now = mm_now_ns();
+    MemBlock* current = purge_cursor != NULL ? purge_cursor : pool_head;
+
+    size_t visited = 0;
+    for (; current != NULL && visited < max_blocks; current = current->next_block) {
+        visited++;
+        if (!current->is_available || now - current->freed_at < decay_ns) {
+            continue;
+        }
+        char* start;
+        size_t length = purgeable_length(current, &start);
+        if (length > current->released && madvise(start, length, MADV_DONTNEED) == 0) {
+            stats->ranges++;
+            stats->bytes += length - current->released;
+            released_bytes += length - current->released;
+            current->released = length;
+        }
+    }
+    purge_cursor = current;
+    pthread_mutex_unlock(&pool_lock);
+    return visited;
+}
+
+static size_t ff_released(void) {
+    pthread_mutex_lock(&pool_lock);
+    size_t released = released_bytes;
+    pthread_mutex_unlock(&pool_lock);
+    return released;
+}
+
+// Best-fit använder samma pool och slår bara på den noggrannare sökningen
+static void bf_init(size_t pool_size) {
+    ff_init(pool_size);
+    best_fit = 1;
+}
+
+static void bf_init_growable(size_t initial_size, size_t max_size) {
+    ff_init_growable(initial_size, max_size);
+    best_fit = 1;
+}
+
+const MemBackend mm_firstfit_backend = {
+    "firstfit", ff_init, ff_init_growable, ff_alloc, ff_alloc_contiguous, ff_free,
+    ff_free_batch, ff_resize, ff_reserve, ff_pool_base, ff_deinit, ff_purge, ff_released,
+    ff_alloc_zeroed, ff_usable_size
+};
+
+const MemBackend mm_bestfit_backend = {
+    "bestfit", bf_init, bf_init_growable, ff_alloc, ff_alloc_contiguous, ff_free,
+    ff_free_batch, ff_resize, ff_reserve, ff_pool_base, ff_deinit, ff_purge, ff_released,
+    ff_alloc_zeroed, ff_usable_size
+};
@@ -0,0 +1,395 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <signal.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <execinfo.h>
+#include "mm_backend.h"
+
+// Samplande heapprofilerare. Varje tråd räknar ned allokerade byte och tar ett stickprov
+// när räknaren passerar noll; avståndet till nästa stickprov dras ur en exponentialfördelning
+// med medelvärdet profile_period, så att pprof kan skala upp stickproven till hela heapen.
+// Ett stickprov sparar en stackspårning, och pekaren följs tills den frigörs.
+
+#define PROFILE_DEPTH 32            // Ramar per stackspårning
+#define PROFILE_SKIP 2              // mm_profile_sample och mem_*-funktionen som anropade den
+#define PROFILE_STACKS 4096         // Olika anropsställen, tvåpotens
+#define PROFILE_LIVE_SLOTS 65536    // Levande stickprov, tvåpotens
+#define PROFILE_LIVE_MAX (PROFILE_LIVE_SLOTS / 4 * 3)
+
+#define SLOT_EMPTY 0
+#define SLOT_DELETED 1
+
+typedef struct ProfileStack {
+    uint64_t hash;
+    int depth;
+    void* frames[PROFILE_DEPTH];
+    size_t alloc_count;
+    size_t alloc_bytes;
+    size_t live_count;
+    size_t live_bytes;
+} ProfileStack;
+
+// Nyckeln skrivs sist, så en läsare utan lås ser aldrig en halvfärdig plats
+typedef struct LiveSlot {
+    atomic_uintptr_t ptr;
+    size_t size;
+    int stack;
+} LiveSlot;
+
+atomic_size_t mm_profile_period = 0;
+atomic_size_t mm_profile_live = 0;
+__thread int64_t mm_profile_countdown = 0;
+
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+static ProfileStack* stacks = NULL;
+static int stack_count = 0;
+static int stack_index[PROFILE_STACKS * 2];  // Hashtabell över stacks, -1 är tom
+static LiveSlot* live_slots = NULL;
+static size_t live_used = 0;                 // Platser som inte är tomma, borttagna inräknade
+static MemProfileStats profile_stats;
+static int profile_configured = 0;           // mem_profile_start/stop går före MM_PROFILE_RATE
+
+static __thread uint64_t sample_seed = 0;
+static __thread int in_sample = 0;
+
+// Signalhanteraren väcker bara dumptråden, skrivningen är inte signalsäker
+static sem_t dump_request;
+static pthread_t dump_thread;
+static int dump_running = 0;
+static atomic_int dump_stopping = 0;
+static int dump_signal = 0;
+static struct sigaction previous_action;
+static char dump_prefix[256];
+static atomic_uint dump_sequence = 0;
+
+static inline size_t hash_pointer(uintptr_t ptr) {
+    return (size_t) ((ptr >> 4) * 0x9E3779B97F4A7C15ull >> 32) & (PROFILE_LIVE_SLOTS - 1);
+}
+
+// Exponentialfördelat avstånd med medelvärdet period, så att stickproven inte följer
+// ett periodiskt allokeringsmönster
+static int64_t next_interval(size_t period) {
+    if (sample_seed == 0) {
+        sample_seed = mm_now_ns() ^ (uintptr_t) &sample_seed;
+    }
+    sample_seed ^= sample_seed << 13;
+    sample_seed ^= sample_seed >> 7;
+    sample_seed ^= sample_seed << 17;
+    double u = ((sample_seed >> 11) + 1.0) / 9007199254740993.0;  // (0, 1]
+    double interval = -log(u) * (double) period;
+    return interval < 1.0 ? 1 : (int64_t) interval;
+}
+
+// Hitta eller lägg till anropsstället, anropas med profile_lock taget
+static int find_stack(void** frames, int depth) {
+    uint64_t hash = 1469598103934665603ull;
+    for (int i = 0; i < depth; i++) {
+        hash = (hash ^ (uintptr_t) frames[i]) * 1099511628211ull;
+    }
+    size_t mask = PROFILE_STACKS * 2 - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        int index = stack_index[i];
+        if (index < 0) {
+            if (stack_count == PROFILE_STACKS) {
+                return -1;
+            }
+            ProfileStack* stack = &stacks[stack_count];
+            memset(stack, 0, sizeof(ProfileStack));
+            stack->hash = hash;
+            stack->depth = depth;
+            memcpy(stack->frames, frames, sizeof(void*) * depth);
+            stack_index[i] = stack_count;
+            return stack_count++;
+        }
+        if (stacks[index].hash == hash && stacks[index].depth == depth &&
+            memcmp(stacks[index].frames, frames, sizeof(void*) * depth) == 0) {
+            return index;
+        }
+    }
+}
+
+// Skapa tabellerna, anropas med profile_lock taget
+static int prepare_tables(void) {
+    if (stacks == NULL) {
+        stacks = (ProfileStack*) calloc(PROFILE_STACKS, sizeof(ProfileStack));
+        live_slots = (LiveSlot*) calloc(PROFILE_LIVE_SLOTS, sizeof(LiveSlot));
+        if (stacks == NULL || live_slots == NULL) {
+            free(stacks);
+            free(live_slots);
+            stacks = NULL;
+            live_slots = NULL;
+            return -1;
+        }
+        memset(stack_index, -1, sizeof(stack_index));
+    }
+    return 0;
+}
+
+void mm_profile_sample(void* ptr, size_t size) {
+    size_t period = atomic_load_explicit(&mm_profile_period, memory_order_relaxed);
+    if (period == 0 || in_sample) {
+        return;
+    }
+    int first = sample_seed == 0;
+    mm_profile_countdown = next_interval(period);
+    if (first) {
+        return;  // Trådens första anrop startar bara nedräkningen
+    }
+
+    in_sample = 1;
+    void* frames[PROFILE_DEPTH + PROFILE_SKIP];
+    int depth = backtrace(frames, PROFILE_DEPTH + PROFILE_SKIP) - PROFILE_SKIP;
+    if (depth < 0) {
+        depth = 0;
+    }
+
+    pthread_mutex_lock(&profile_lock);
+    int stack = stacks != NULL ? find_stack(frames + PROFILE_SKIP, depth) : -1;
+    if (stack < 0 || live_used >= PROFILE_LIVE_MAX) {
+        profile_stats.dropped++;
+    } else {
+        stacks[stack].alloc_count++;
+        stacks[stack].alloc_bytes += size;
+        stacks[stack].live_count++;
+        stacks[stack].live_bytes += size;
+        profile_stats.samples++;
+
+        size_t i = hash_pointer((uintptr_t) ptr);
+        uintptr_t key;
+        while ((key = atomic_load_explicit(&live_slots[i].ptr, memory_order_relaxed)) > SLOT_DELETED) {
+            i = (i + 1) & (PROFILE_LIVE_SLOTS - 1);
+        }
+        if (key == SLOT_EMPTY) {
+            live_used++;
+        }
+        live_slots[i].size = size;
+        live_slots[i].stack = stack;
+        atomic_store_explicit(&live_slots[i].ptr, (uintptr_t) ptr, memory_order_release);
+        atomic_fetch_add_explicit(&mm_profile_live, 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&profile_lock);
+    in_sample = 0;
+}
+
+// En borttagen plats följd av en tom kan inte ligga i någon kedja som fortsätter efter den,
+// så den blir tom igen, och likaså borttagna platser bakåt. Anropas med profile_lock taget.
+static void clear_deleted(size_t i) {
+    size_t mask = PROFILE_LIVE_SLOTS - 1;
+    while (atomic_load_explicit(&live_slots[(i + 1) & mask].ptr, memory_order_relaxed) == SLOT_EMPTY &&
+           atomic_load_explicit(&live_slots[i].ptr, memory_order_relaxed) == SLOT_DELETED) {
+        atomic_store_explicit(&live_slots[i].ptr, SLOT_EMPTY, memory_order_relaxed);
+        live_used--;
+        i = (i - 1) & mask;
+    }
+}
+
+// Letar utan lås, så frigöringar av block som inte provtagits tar aldrig profile_lock
+void mm_profile_forget(void* ptr) {
+    if (ptr == NULL || live_slots == NULL) {
+        return;
+    }
+    size_t i = hash_pointer((uintptr_t) ptr);
+    uintptr_t key;
+    while ((key = atomic_load_explicit(&live_slots[i].ptr, memory_order_acquire)) != SLOT_EMPTY) {
+        if (key == (uintptr_t) ptr) {
+            pthread_mutex_lock(&profile_lock);
+            if (atomic_load_explicit(&live_slots[i].ptr, memory_order_relaxed) == key) {
+                ProfileStack* stack = &stacks[live_slots[i].stack];
+                stack->live_count--;
+                stack->live_bytes -= live_slots[i].size;
+                atomic_store_explicit(&live_slots[i].ptr, SLOT_DELETED, memory_order_relaxed);
+                atomic_fetch_sub_explicit(&mm_profile_live, 1, memory_order_relaxed);
+                clear_deleted(i);
+            }
+            pthread_mutex_unlock(&profile_lock);
+            return;
+        }
+        i = (i + 1) & (PROFILE_LIVE_SLOTS - 1);
+    }
+}
+
+// Poolen är borta, alla levande stickprov glöms men anropsställenas summor finns kvar
+void mm_profile_reset_live(void) {
+    pthread_mutex_lock(&profile_lock);
+    if (live_slots != NULL) {
+        memset(live_slots, 0, sizeof(LiveSlot) * PROFILE_LIVE_SLOTS);
+        for (int i = 0; i < stack_count; i++) {
+            stacks[i].live_count = 0;
+            stacks[i].live_bytes = 0;
+        }
+    }
+    live_used = 0;
+    atomic_store_explicit(&mm_profile_live, 0, memory_order_relaxed);
+    pthread_mutex_unlock(&profile_lock);
+}
+
+int mem_profile_start(size_t sample_bytes) {
+    if (sample_bytes == 0) {
+        return -1;
+    }
+    // Första backtrace laddar avvecklingsbiblioteket, det ska inte ske mitt i en allokering
+    void* frame;
+    backtrace(&frame, 1);
+
+    pthread_mutex_lock(&profile_lock);
+    profile_configured = 1;
+    int result = prepare_tables();
+    if (result == 0) {
+        atomic_store_explicit(&mm_profile_period, sample_bytes, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&profile_lock);
+    return result;
+}
+
+// Block som redan provtagits följs fortfarande tills de frigörs
+void mem_profile_stop(void) {
+    pthread_mutex_lock(&profile_lock);
+    profile_configured = 1;
+    atomic_store_explicit(&mm_profile_period, 0, memory_order_relaxed);
+    pthread_mutex_unlock(&profile_lock);
+}
+
+void mm_profile_from_env(void) {
+    pthread_mutex_lock(&profile_lock);
+    int configured = profile_configured;
+    pthread_mutex_unlock(&profile_lock);
+    const char* value = getenv("MM_PROFILE_RATE");
+    if (!configured && value != NULL && strtoull(value, NULL, 10) != 0) {
+        mem_profile_start((size_t) strtoull(value, NULL, 10));
+    }
+}
+
+void mem_profile_stats(MemProfileStats* stats) {
+    pthread_mutex_lock(&profile_lock);
+    *stats = profile_stats;
+    stats->live_samples = 0;
+    stats->live_bytes = 0;
+    for (int i = 0; i < stack_count; i++) {
+        stats->live_samples += stacks[i].live_count;
+        stats->live_bytes += stacks[i].live_bytes;
+    }
+    pthread_mutex_unlock(&profile_lock);
+}
+
+// Skriv profilen i pprofs textformat för heapar: en rad per anropsställe med levande och
+// totalt provtagna objekt och byte, följt av processens mappningar för symbolupplösning
+int mem_profile_dump(const char* path) {
+    pthread_mutex_lock(&profile_lock);
+    int count = stack_count;
+    ProfileStack* copy = (ProfileStack*) malloc(sizeof(ProfileStack) * (count ? count : 1));
+    if (copy == NULL) {
+        pthread_mutex_unlock(&profile_lock);
+        return -1;
+    }
+    if (count > 0) {
+        memcpy(copy, stacks, sizeof(ProfileStack) * count);
+    }
+    size_t period = atomic_load_explicit(&mm_profile_period, memory_order_relaxed);
+    pthread_mutex_unlock(&profile_lock);
+
+    FILE* out = fopen(path, "w");
+    if (out == NULL) {
+        free(copy);
+        return -1;
+    }
+
+    size_t live_count = 0, live_bytes = 0, alloc_count = 0, alloc_bytes = 0;
+    for (int i = 0; i < count; i++) {
+        live_count += copy[i].live_count;
+        live_bytes += copy[i].live_bytes;
+        alloc_count += copy[i].alloc_count;
+        alloc_bytes += copy[i].alloc_bytes;
+    }
+    fprintf(out, "heap profile: %zu: %zu [%zu: %zu] @ heap_v2/%zu\n",
+            live_count, live_bytes, alloc_count, alloc_bytes, period ? period : 1);
+    for (int i = 0; i < count; i++) {
+        fprintf(out, "%zu: %zu [%zu: %zu] @", copy[i].live_count, copy[i].live_bytes,
+                copy[i].alloc_count, copy[i].alloc_bytes);
+        for (int f = 0; f < copy[i].depth; f++) {
+            fprintf(out, " %p", copy[i].frames[f]);
+        }
+        fputc('\n', out);
+    }
+    free(copy);
+
+    fputs("\nMAPPED_LIBRARIES:\n", out);
+    FILE* maps = fopen("/proc/self/maps", "r");
+    if (maps != NULL) {
+        char buffer[4096];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), maps)) > 0) {
+            fwrite(buffer, 1, n, out);
+        }
+        fclose(maps);
+    }
+    return fclose(out) == 0 ? 0 : -1;
+}
+
+static void dump_on_signal(int signo) {
+    (void) signo;
+    sem_post(&dump_request);
+}
+
+static void* dump_main(void* arg) {
+    (void) arg;
+    for (;;) {
+        while (sem_wait(&dump_request) != 0) {
+        }
+        if (atomic_load(&dump_stopping)) {
+            break;
+        }
+        char path[320];
+        snprintf(path, sizeof(path), "%s.%d.%u.heap", dump_prefix, (int) getpid(),
+                 atomic_fetch_add(&dump_sequence, 1));
+        mem_profile_dump(path);
+    }
+    return NULL;
+}
+
+int mem_profile_dump_on_signal(int signo, const char* prefix) {
+    mem_profile_dump_on_signal_stop();
+    snprintf(dump_prefix, sizeof(dump_prefix), "%s", prefix);
+    atomic_store(&dump_stopping, 0);
+    if (sem_init(&dump_request, 0, 0) != 0) {
+        return -1;
+    }
+    if (pthread_create(&dump_thread, NULL, dump_main, NULL) != 0) {
+        sem_destroy(&dump_request);
+        return -1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = dump_on_signal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(signo, &action, &previous_action) != 0) {
+        atomic_store(&dump_stopping, 1);
+        sem_post(&dump_request);
+        pthread_join(dump_thread, NULL);
+        sem_destroy(&dump_request);
+        return -1;
+    }
+    dump_signal = signo;
+    dump_running = 1;
+    return 0;
+}
+
+void mem_profile_dump_on_signal_stop(void) {
+    if (!dump_running) {
+        return;
+    }
+    sigaction(dump_signal, &previous_action, NULL);
+    atomic_store(&dump_stopping, 1);
+    sem_post(&dump_request);
+    pthread_join(dump_thread, NULL);
+    sem_destroy(&dump_request);
+    dump_running = 0;
+}
@@ -0,0 +1,867 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mm_backend.h"
+
+// Two-Level Segregated Fit bakom samma gränssnitt som first-fit-poolen i mm_firstfit.c.
+// Lediga block sorteras i klasser: första nivån är tvåpotensen av storleken, andra nivån
+// delar varje tvåpotens i TLSF_SL_COUNT lika breda intervall. Två nivåer av bitkartor gör
+// att en passande klass hittas med två bitsökningar, så mem_alloc och mem_free tar
+// konstant tid oavsett hur många block poolen har.
+//
+// Poolen delas i granuler om 16 byte. För varje granul finns en tagg utanför poolen som,
+// om ett block börjar där, håller blockets storlek och om blocket och blocket före är lediga.
+// Lediga block bär sina listlänkar och sin storlek (sist i blocket) i sin egen nyttolast.
+
+#define TLSF_GRANULE_SHIFT 4
+#define TLSF_GRANULE ((size_t) 1 << TLSF_GRANULE_SHIFT)
+#define TLSF_SL_BITS 4
+#define TLSF_SL_COUNT (1 << TLSF_SL_BITS)
+#define TLSF_FL_COUNT 32
+#define TLSF_SMALL_LIMIT ((size_t) TLSF_SL_COUNT << TLSF_GRANULE_SHIFT)  // Under detta är klasserna linjära
+#define TLSF_DEFAULT_MAX ((size_t) 1 << 30)  // Reservation när mem_init_growable saknar gräns
+#define TLSF_MAX_GRANULES ((size_t) 1 << 30) // Storleken i en tagg har 30 bitar
+#define TLSF_NIL UINT32_MAX
+
+// Taggens bitar: storlek i granuler << 2 | föregående block ledigt | blocket ledigt
+#define TAG_FREE 1u
+#define TAG_PREV_FREE 2u
+#define TAG_SIZE(tag) ((tag) >> 2)
+
+typedef struct TlsfFree {
+    uint32_t next;  // Granulindex för nästa lediga block i samma klass
+    uint32_t prev;
+} TlsfFree;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static char* pool_start = NULL;
+static size_t pool_granules = 0;   // Granuler i bruk
+static size_t pool_reserved = 0;   // Reserverad adressrymd i byte
+static int pool_growable = 0;
+
+// Taggen på index pool_granules är en vaktpost som bara bär TAG_PREV_FREE för sista blocket
+static uint32_t* tags = NULL;
+static size_t tags_bytes = 0;
+
+// Klassernas bitkartor och listhuvuden. Allt är granulindex, så för en filpool ligger
+// de i filens huvud och gäller var filen än mappas.
+typedef struct TlsfControl {
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[TLSF_FL_COUNT];
+    uint32_t heads[TLSF_FL_COUNT][TLSF_SL_COUNT];
+} TlsfControl;
+
+static TlsfControl local_control;
+static TlsfControl* control = &local_control;
+
+// En filpool lägger huvudet, taggarna och poolen efter varandra i en delad mappning
+#define TLSF_FILE_MAGIC 0x4c4f4f5046534c54ull  // "TLSFPOOL"
+#define TLSF_FILE_VERSION ((2u << 24) | (TLSF_GRANULE_SHIFT << 16) | (TLSF_FL_COUNT << 8) | TLSF_SL_COUNT)
+
+typedef struct TlsfFileHeader {
+    uint64_t magic;
+    uint32_t version;       // Ändras om filens eller klassernas layout ändras
+    uint32_t clean;         // 1 om poolen stängdes med mem_deinit
+    uint64_t length;        // Filens storlek
+    uint64_t granules;      // Poolens storlek i granuler
+    uint64_t tags_offset;   // Förskjutningar från filens början
+    uint64_t pool_offset;
+    uint64_t root;          // Rotens förskjutning i poolen + 1, 0 betyder ingen rot
+    atomic_uint ready;      // Sätts sist när en delad pool är färdig att användas
+    pthread_mutex_t lock;   // Delat mellan processer och robust mot att en ägare dör
+    TlsfControl control;
+} TlsfFileHeader;
+
+static TlsfFileHeader* file_header = NULL;  // NULL om poolen inte är filbaserad
+static int pool_shared = 0;                 // Poolen ligger i delat minne och kan ha andra processer
+
+static size_t round_to_page(size_t size) {
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    return (size + page - 1) / page * page;
+}
+
+static inline TlsfFree* free_node(size_t granule) {
+    return (TlsfFree*) (pool_start + (granule << TLSF_GRANULE_SHIFT));
+}
+
+// Sista fyra byten i ett ledigt block håller dess storlek, så blocket efter hittar början
+static inline uint32_t* footer_before(size_t granule) {
+    return (uint32_t*) (pool_start + (granule << TLSF_GRANULE_SHIFT)) - 1;
+}
+
+// ---- Storleksklasser ----
+
+static inline int fls_size(size_t size) {
+    return 63 - __builtin_clzll((unsigned long long) size);
+}
+
+static void mapping(size_t size, int* fl, int* sl) {
+    if (size < TLSF_SMALL_LIMIT) {
+        *fl = 0;
+        *sl = (int) (size >> TLSF_GRANULE_SHIFT);
+    } else {
+        int f = fls_size(size);
+        *fl = f - (TLSF_SL_BITS + TLSF_GRANULE_SHIFT) + 1;
+        *sl = (int) (size >> (f - TLSF_SL_BITS)) - TLSF_SL_COUNT;
+    }
+}
+
+// Första klassen där alla block är minst size byte: avrunda uppåt till nästa klassgräns
+static void mapping_search(size_t size, int* fl, int* sl) {
+    if (size >= TLSF_SMALL_LIMIT) {
+        size += ((size_t) 1 << (fls_size(size) - TLSF_SL_BITS)) - 1;
+    }
+    mapping(size, fl, sl);
+}
+
+// Närmaste icke-tomma klass från (fl, sl) och uppåt, TLSF_NIL om ingen finns
+static uint32_t find_suitable(int fl, int sl) {
+    if (fl >= TLSF_FL_COUNT) {
+        return TLSF_NIL;
+    }
+    uint32_t sl_map = sl < TLSF_SL_COUNT ? control->sl_bitmap[fl] & (~0u << sl) : 0;
+    if (sl_map == 0) {
+        uint32_t fl_map = fl + 1 < TLSF_FL_COUNT ? control->fl_bitmap & (~0u << (fl + 1)) : 0;
+        if (fl_map == 0) {
+            return TLSF_NIL;
+        }
+        fl = __builtin_ctz(fl_map);
+        sl_map = control->sl_bitmap[fl];
+    }
+    return control->heads[fl][__builtin_ctz(sl_map)];
+}
+
+// ---- Lediga block ----
+
+static void insert_free(size_t granule, size_t size) {
+    int fl, sl;
+    mapping(size << TLSF_GRANULE_SHIFT, &fl, &sl);
+
+    TlsfFree* node = free_node(granule);
+    node->prev = TLSF_NIL;
+    node->next = control->heads[fl][sl];
+    if (node->next != TLSF_NIL) {
+        free_node(node->next)->prev = (uint32_t) granule;
+    }
+    control->heads[fl][sl] = (uint32_t) granule;
+    control->fl_bitmap |= 1u << fl;
+    control->sl_bitmap[fl] |= 1u << sl;
+
+    // Föregående block är aldrig ledigt här, två lediga grannar slås alltid ihop
+    tags[granule] = (uint32_t) (size << 2) | TAG_FREE;
+    *footer_before(granule + size) = (uint32_t) size;
+    tags[granule + size] |= TAG_PREV_FREE;
+}
+
+static void remove_free(size_t granule) {
+    size_t size = TAG_SIZE(tags[granule]);
+    int fl, sl;
+    mapping(size << TLSF_GRANULE_SHIFT, &fl, &sl);
+
+    TlsfFree* node = free_node(granule);
+    if (node->prev != TLSF_NIL) {
+        free_node(node->prev)->next = node->next;
+    } else {
+        control->heads[fl][sl] = node->next;
+        if (node->next == TLSF_NIL) {
+            control->sl_bitmap[fl] &= ~(1u << sl);
+            if (control->sl_bitmap[fl] == 0) {
+                control->fl_bitmap &= ~(1u << fl);
+            }
+        }
+    }
+    if (node->next != TLSF_NIL) {
+        free_node(node->next)->prev = node->prev;
+    }
+    tags[granule] &= ~TAG_FREE;
+    tags[granule + size] &= ~TAG_PREV_FREE;
+}
+
+// Slå ihop ett block med lediga grannar och lägg in resultatet som ledigt
+static void release(size_t granule, size_t size) {
+    size_t next = granule + size;
+    if (next < pool_granules && (tags[next] & TAG_FREE)) {
+        size_t next_size = TAG_SIZE(tags[next]);
+        remove_free(next);
+        tags[next] = 0;  // Inte längre början på ett block
+        size += next_size;
+    }
+    if (tags[granule] & TAG_PREV_FREE) {
+        size_t prev_size = *footer_before(granule);
+        size_t prev = granule - prev_size;
+        remove_free(prev);
+        tags[granule] = 0;
+        granule = prev;
+        size += prev_size;
+    }
+    insert_free(granule, size);
+}
+
+// ---- Poolen ----
+
+static void reset_classes(void) {
+    control->fl_bitmap = 0;
+    memset(control->sl_bitmap, 0, sizeof(control->sl_bitmap));
+    for (int fl = 0; fl < TLSF_FL_COUNT; fl++) {
+        for (int sl = 0; sl < TLSF_SL_COUNT; sl++) {
+            control->heads[fl][sl] = TLSF_NIL;
+        }
+    }
+}
+
+static void release_pool(void) {
+    if (file_header != NULL && pool_shared) {
+        // Andra processer kan fortfarande använda poolen, den tas bort med mem_unlink_shared
+        munmap(file_header, file_header->length);
+        file_header = NULL;
+    } else if (file_header != NULL) {
+        // Allt skrivs ut innan poolen märks som ren, så en krasch däremellan syns vid nästa öppning
+        size_t length = file_header->length;
+        msync(file_header, length, MS_SYNC);
+        file_header->clean = 1;
+        msync(file_header, sizeof(TlsfFileHeader), MS_SYNC);
+        munmap(file_header, length);
+        file_header = NULL;
+    } else {
+        if (pool_start != NULL) {
+            munmap(pool_start, pool_reserved);
+        }
+        if (tags != NULL) {
+            munmap(tags, tags_bytes);
+        }
+    }
+    pool_start = NULL;
+    tags = NULL;
+    pool_granules = 0;
+    pool_reserved = 0;
+    pool_growable = 0;
+    pool_shared = 0;
+    tags_bytes = 0;
+    control = &local_control;
+    reset_classes();
+}
+
+// Ta [from, to) i bruk som ett ledigt block, ihopslaget med ett ledigt sista block
+static void add_range(size_t from, size_t to) {
+    if (to <= from) {
+        return;
+    }
+    tags[from] = (uint32_t) ((to - from) << 2) | (tags[from] & TAG_PREV_FREE);
+    tags[to] = 0;
+    pool_granules = to;
+    release(from, to - from);
+}
+
+static void setup_pool(size_t committed, size_t reserved, int growable) {
+    release_pool();
+
+    size_t granules = reserved >> TLSF_GRANULE_SHIFT;
+    if (granules >= TLSF_MAX_GRANULES) {
+        granules = TLSF_MAX_GRANULES - 1;
+    }
+    tags_bytes = round_to_page((granules + 1) * sizeof(uint32_t));
+    void* tag_map = mmap(NULL, tags_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    void* base = mmap(NULL, reserved, growable ? PROT_NONE : PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (tag_map == MAP_FAILED || base == MAP_FAILED) {
+        perror("Misslyckades med att allokera minnespool");
+        exit(EXIT_FAILURE);
+    }
+    if (growable && mprotect(base, committed, PROT_READ | PROT_WRITE) != 0) {
+        perror("Misslyckades med att allokera minnespool");
+        exit(EXIT_FAILURE);
+    }
+
+    tags = (uint32_t*) tag_map;
+    pool_start = (char*) base;
+    pool_reserved = reserved;
+    pool_growable = growable;
+
+    size_t committed_granules = committed >> TLSF_GRANULE_SHIFT;
+    add_range(0, committed_granules < granules ? committed_granules : granules);
+}
+
+// Väx med minst poolens nuvarande storlek, det nya området slås ihop med ett ledigt sista block
+static int grow_pool(size_t needed) {
+    if (!pool_growable) {
+        return -1;
+    }
+    size_t size = pool_granules << TLSF_GRANULE_SHIFT;
+    size_t grow = round_to_page(needed > size ? needed : size);
+    if (grow > pool_reserved - size) {
+        grow = pool_reserved - size;
+    }
+    if (grow < needed || grow == 0 || ((size + grow) >> TLSF_GRANULE_SHIFT) >= TLSF_MAX_GRANULES) {
+        return -1;
+    }
+    if (mprotect(pool_start + size, grow, PROT_READ | PROT_WRITE) != 0) {
+        return -1;
+    }
+    add_range(pool_granules, (size + grow) >> TLSF_GRANULE_SHIFT);
+    return 0;
+}
+
+static void tlsf_init(size_t size) {
+    pthread_mutex_lock(&pool_lock);
+    // Poolen rundas upp till hela granuler, så varje begärd byte går att allokera
+    size_t committed = (size + TLSF_GRANULE - 1) & ~(TLSF_GRANULE - 1);
+    setup_pool(committed, round_to_page(committed ? committed : 1), 0);
+    pthread_mutex_unlock(&pool_lock);
+}
+
+static void tlsf_init_growable(size_t initial_size, size_t max_size) {
+    pthread_mutex_lock(&pool_lock);
+    size_t reserved = round_to_page(max_size ? max_size : TLSF_DEFAULT_MAX);
+    size_t committed = round_to_page(initial_size ? initial_size : 1);
+    if (reserved < committed) {
+        reserved = committed;
+    }
+    setup_pool(committed, reserved, 1);
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// ---- Låsning ----
+
+static int check_pool(void);
+
+// Bygg om klasslistorna från taggarna, efter en process som dog mitt i en ändring.
+// Intilliggande lediga block slås ihop. Returnerar -1 om taggarna inte går att följa.
+static int rebuild_classes(void) {
+    reset_classes();
+    size_t free_start = SIZE_MAX;
+    size_t granule = 0;
+    while (granule < pool_granules) {
+        size_t size = TAG_SIZE(tags[granule]);
+        if (size == 0 || size > pool_granules - granule) {
+            return -1;
+        }
+        int is_free = (tags[granule] & TAG_FREE) != 0;
+        tags[granule] &= ~TAG_PREV_FREE;
+        if (is_free && free_start == SIZE_MAX) {
+            free_start = granule;
+        } else if (is_free) {
+            tags[granule] = 0;  // Blir en del av det lediga blocket före
+        } else if (free_start != SIZE_MAX) {
+            insert_free(free_start, granule - free_start);
+            free_start = SIZE_MAX;
+        }
+        granule += size;
+    }
+    tags[pool_granules] &= ~TAG_PREV_FREE;
+    if (free_start != SIZE_MAX) {
+        insert_free(free_start, pool_granules - free_start);
+    }
+    return 0;
+}
+
+// En fil- eller delad pool låses dessutom med mutexen i huvudet, så att processer som
+// delar poolen inte krockar. Dog ägaren med låset taget repareras klasslistorna först.
+static void lock_pool(void) {
+    pthread_mutex_lock(&pool_lock);
+    if (file_header != NULL && pthread_mutex_lock(&file_header->lock) == EOWNERDEAD) {
+        if (check_pool() != 0 && rebuild_classes() != 0) {
+            mem_report(MEM_ERR_POOL_CORRUPT, file_header);
+        }
+        pthread_mutex_consistent(&file_header->lock);
+    }
+}
+
+static void unlock_pool(void) {
+    if (file_header != NULL) {
+        pthread_mutex_unlock(&file_header->lock);
+    }
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// ---- Allokering ----
+
+// Ett ledigt block med minst 'granules' granuler, TLSF_NIL om inget finns.
+// Den avrundade klassen garanterar passform. Annars prövas första blocket i den exakta
+// klassen, så att ett block av exakt rätt storlek alltid kan användas.
+static uint32_t find_block(size_t granules) {
+    size_t size = granules << TLSF_GRANULE_SHIFT;
+    int fl, sl;
+    mapping_search(size, &fl, &sl);
+    uint32_t block = find_suitable(fl, sl);
+    if (block == TLSF_NIL) {
+        mapping(size, &fl, &sl);
+        if (fl < TLSF_FL_COUNT) {
+            uint32_t head = control->heads[fl][sl];
+            if (head != TLSF_NIL && TAG_SIZE(tags[head]) >= granules) {
+                block = head;
+            }
+        }
+    }
+    return block;
+}
+
+static void* alloc_locked(size_t size) {
+    if (pool_start == NULL || size > (TLSF_MAX_GRANULES - 1) << TLSF_GRANULE_SHIFT) {
+        return NULL;
+    }
+    size_t granules = (size + TLSF_GRANULE - 1) >> TLSF_GRANULE_SHIFT;
+    uint32_t block;
+    while ((block = find_block(granules)) == TLSF_NIL) {
+        if (grow_pool(granules << TLSF_GRANULE_SHIFT) != 0) {
+            return NULL;
+        }
+    }
+
+    size_t block_size = TAG_SIZE(tags[block]);
+    remove_free(block);
+    if (block_size > granules) {
+        // Resten blir ett eget ledigt block, grannen efter är upptagen så ingen sammanslagning
+        tags[block] = (uint32_t) (granules << 2);
+        insert_free(block + granules, block_size - granules);
+    }
+    return pool_start + ((size_t) block << TLSF_GRANULE_SHIFT);
+}
+
+static void* tlsf_alloc(size_t size) {
+    lock_pool();
+    void* ptr = NULL;
+    if (size == 0) {
+        // Reservera ingenting, returnera adressen som nästa minsta allokering skulle få
+        uint32_t block = pool_start != NULL ? find_block(1) : TLSF_NIL;
+        if (block != TLSF_NIL) {
+            ptr = pool_start + ((size_t) block << TLSF_GRANULE_SHIFT);
+        }
+    } else {
+        ptr = alloc_locked(size);
+    }
+    unlock_pool();
+    return ptr;
+}
+
+static void* tlsf_alloc_contiguous(size_t size, size_t count) {
+    if (size == 0 || count == 0 || count > SIZE_MAX / size) {
+        return NULL;
+    }
+
+    // Taggarna sitter per granul, så ett element som inte börjar på ett granul kan
+    // inte bli ett eget block. Hellre inget än en körning som bara kan frigöras hel.
+    if (count > 1 && (size & (TLSF_GRANULE - 1)) != 0) {
+        return NULL;
+    }
+
+    lock_pool();
+    char* run = (char*) alloc_locked(size * count);
+    if (run && count > 1) {
+        // Varje element får en egen tagg och blir ett eget block som kan frigöras för sig
+        size_t first = (size_t) (run - pool_start) >> TLSF_GRANULE_SHIFT;
+        size_t unit = size >> TLSF_GRANULE_SHIFT;
+        for (size_t i = 0; i < count; i++) {
+            tags[first + i * unit] = (uint32_t) (unit << 2);
+        }
+    }
+    unlock_pool();
+    return run;
+}
+
+// ---- Frigöring ----
+
+// Granulindex för blocket som börjar vid ptr, SIZE_MAX om ptr inte är början på ett block
+static size_t block_of(void* ptr) {
+    char* p = (char*) ptr;
+    if (pool_start == NULL || p < pool_start || p >= pool_start + (pool_granules << TLSF_GRANULE_SHIFT)) {
+        return SIZE_MAX;
+    }
+    size_t offset = (size_t) (p - pool_start);
+    if ((offset & (TLSF_GRANULE - 1)) != 0 || TAG_SIZE(tags[offset >> TLSF_GRANULE_SHIFT]) == 0) {
+        return SIZE_MAX;
+    }
+    return offset >> TLSF_GRANULE_SHIFT;
+}
+
+static void free_locked(void* ptr) {
+    if (!ptr) {
+        mem_report(MEM_ERR_NULL_FREE, NULL);
+        return;
+    }
+    size_t block = block_of(ptr);
+    if (block == SIZE_MAX) {
+        mem_report(MEM_ERR_FOREIGN_POINTER, ptr);
+        return;
+    }
+    if (tags[block] & TAG_FREE) {
+        mem_report(MEM_ERR_DOUBLE_FREE, ptr);
+        return;
+    }
+    release(block, TAG_SIZE(tags[block]));
+}
+
+static void tlsf_free(void* ptr) {
+    lock_pool();
+    free_locked(ptr);
+    unlock_pool();
+}
+
+// Varje frigöring tar konstant tid, så en batch behöver bara ta låset en gång
+static void tlsf_free_batch(void** ptrs, size_t count) {
+    lock_pool();
+    for (size_t i = 0; i < count; i++) {
+        free_locked(ptrs[i]);
+    }
+    unlock_pool();
+}
+
+static void* tlsf_resize(void* ptr, size_t size) {
+    if (!ptr) return tlsf_alloc(size); // Om pekaren är NULL, allokera nytt minne
+
+    lock_pool();
+    size_t block = block_of(ptr);
+    if (block == SIZE_MAX || (tags[block] & TAG_FREE)) {
+        unlock_pool();
+        mem_report(MEM_ERR_RESIZE_UNKNOWN, ptr);
+        return NULL;
+    }
+
+    size_t granules = (size + TLSF_GRANULE - 1) >> TLSF_GRANULE_SHIFT;
+    size_t current = TAG_SIZE(tags[block]);
+    void* new_ptr = ptr;  // Blocket räcker redan till
+    if (current < granules) {
+        // Väx på plats om blocket efter är ledigt och stort nog
+        size_t next = block + current;
+        if (next < pool_granules && (tags[next] & TAG_FREE) && current + TAG_SIZE(tags[next]) >= granules) {
+            size_t total = current + TAG_SIZE(tags[next]);
+            remove_free(next);
+            tags[next] = 0;
+            tags[block] = (uint32_t) (granules << 2) | (tags[block] & TAG_PREV_FREE);
+            if (total > granules) {
+                insert_free(block + granules, total - granules);
+            }
+        } else {
+            new_ptr = alloc_locked(size);
+            if (new_ptr) {
+                memcpy(new_ptr, ptr, current << TLSF_GRANULE_SHIFT);
+                free_locked(ptr);
+            }
+        }
+    }
+    unlock_pool();
+    return new_ptr;
+}
+
+// Se till att en allokering av 'size' byte lyckas utan att poolen behöver växa
+static int tlsf_reserve(size_t size) {
+    lock_pool();
+    int result = -1;
+    if (pool_start != NULL && size <= (TLSF_MAX_GRANULES - 1) << TLSF_GRANULE_SHIFT) {
+        size_t granules = (size + TLSF_GRANULE - 1) >> TLSF_GRANULE_SHIFT;
+        while (find_block(granules ? granules : 1) == TLSF_NIL) {
+            if (grow_pool(granules << TLSF_GRANULE_SHIFT) != 0) {
+                break;
+            }
+        }
+        result = find_block(granules ? granules : 1) == TLSF_NIL ? -1 : 0;
+    }
+    unlock_pool();
+    return result;
+}
+
+static size_t tlsf_usable_size(void* ptr) {
+    lock_pool();
+    size_t block = block_of(ptr);
+    size_t usable = 0;
+    if (block != SIZE_MAX && !(tags[block] & TAG_FREE)) {
+        usable = TAG_SIZE(tags[block]) << TLSF_GRANULE_SHIFT;
+    }
+    unlock_pool();
+    return usable;
+}
+
+static void* tlsf_pool_base(void) {
+    return pool_start;
+}
+
+static void tlsf_deinit(void) {
+    pthread_mutex_lock(&pool_lock);
+    release_pool();
+    pthread_mutex_unlock(&pool_lock);
+}
+
+// ---- Filbaserad pool ----
+
+// Gå igenom alla block och alla klasslistor och kontrollera att de stämmer med varandra.
+// Returnerar 0 om poolen är hel.
+static int check_pool(void) {
+    size_t free_blocks = 0;
+    size_t granule = 0;
+    int prev_free = 0;
+    while (granule < pool_granules) {
+        uint32_t tag = tags[granule];
+        size_t size = TAG_SIZE(tag);
+        if (size == 0 || size > pool_granules - granule || ((tag & TAG_PREV_FREE) != 0) != prev_free) {
+            return -1;
+        }
+        prev_free = (tag & TAG_FREE) != 0;
+        if (prev_free) {
+            if (tag & TAG_PREV_FREE) {
+                return -1;  // Två lediga grannar ska alltid vara ihopslagna
+            }
+            if (*footer_before(granule + size) != size) {
+                return -1;
+            }
+            free_blocks++;
+        }
+        granule += size;
+    }
+    if (((tags[pool_granules] & TAG_PREV_FREE) != 0) != prev_free) {
+        return -1;
+    }
+
+    size_t listed = 0;
+    for (int fl = 0; fl < TLSF_FL_COUNT; fl++) {
+        if (((control->fl_bitmap >> fl) & 1) != (control->sl_bitmap[fl] != 0)) {
+            return -1;
+        }
+        for (int sl = 0; sl < TLSF_SL_COUNT; sl++) {
+            uint32_t node = control->heads[fl][sl];
+            if (((control->sl_bitmap[fl] >> sl) & 1) != (node != TLSF_NIL)) {
+                return -1;
+            }
+            uint32_t prev = TLSF_NIL;
+            while (node != TLSF_NIL) {
+                if (node >= pool_granules || !(tags[node] & TAG_FREE) || ++listed > free_blocks ||
+                    free_node(node)->prev != prev) {
+                    return -1;
+                }
+                int node_fl, node_sl;
+                mapping(TAG_SIZE(tags[node]) << TLSF_GRANULE_SHIFT, &node_fl, &node_sl);
+                if (node_fl != fl || node_sl != sl) {
+                    return -1;
+                }
+                prev = node;
+                node = free_node(node)->next;
+            }
+        }
+    }
+    return listed == free_blocks ? 0 : -1;
+}
+
+// Peka ut huvudet, taggarna och poolen i en mappning av filen
+static void attach_file(TlsfFileHeader* header) {
+    file_header = header;
+    control = &header->control;
+    tags = (uint32_t*) ((char*) header + header->tags_offset);
+    pool_start = (char*) header + header->pool_offset;
+    pool_granules = (size_t) header->granules;
+    pool_reserved = pool_granules << TLSF_GRANULE_SHIFT;
+    pool_growable = 0;
+    tags_bytes = 0;
+}
+
+static void detach_file(void) {
+    file_header = NULL;
+    control = &local_control;
+    tags = NULL;
+    pool_start = NULL;
+    pool_granules = 0;
+    pool_reserved = 0;
+}
+
+// Filen måste vara skapad av samma layout och ha plats för allt huvudet pekar ut
+static int valid_header(const TlsfFileHeader* header, size_t length) {
+    return length >= sizeof(TlsfFileHeader) &&
+           header->magic == TLSF_FILE_MAGIC &&
+           header->version == TLSF_FILE_VERSION &&
+           header->length == length &&
+           header->granules > 0 && header->granules < TLSF_MAX_GRANULES &&
+           header->tags_offset >= sizeof(TlsfFileHeader) &&
+           header->tags_offset + (header->granules + 1) * sizeof(uint32_t) <= header->pool_offset &&
+           header->pool_offset + (header->granules << TLSF_GRANULE_SHIFT) <= length &&
+           header->root <= header->granules << TLSF_GRANULE_SHIFT;
+}
+
+// Skapa en ny, tom pool om 'size' byte i filen
+static int format_file(int fd, size_t size) {
+    size_t granules = (size + TLSF_GRANULE - 1) >> TLSF_GRANULE_SHIFT;
+    if (granules == 0) {
+        granules = 1;
+    }
+    if (granules >= TLSF_MAX_GRANULES) {
+        return -1;
+    }
+    size_t tags_offset = round_to_page(sizeof(TlsfFileHeader));
+    size_t pool_offset = tags_offset + round_to_page((granules + 1) * sizeof(uint32_t));
+    size_t length = pool_offset + round_to_page(granules << TLSF_GRANULE_SHIFT);
+
+    // En fil som kortas till noll och förlängs igen läses som nollor
+    if (ftruncate(fd, 0) != 0 || ftruncate(fd, (off_t) length) != 0) {
+        return -1;
+    }
+    void* map = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    TlsfFileHeader* header = (TlsfFileHeader*) map;
+    header->magic = TLSF_FILE_MAGIC;
+    header->version = TLSF_FILE_VERSION;
+    header->length = length;
+    header->granules = granules;
+    header->tags_offset = tags_offset;
+    header->pool_offset = pool_offset;
+    header->root = 0;
+    attach_file(header);
+    reset_classes();
+    pool_granules = 0;
+    add_range(0, granules);
+    return 0;
+}
+
+static void init_header_lock(TlsfFileHeader* header) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&header->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    atomic_store(&header->ready, 1);
+}
+
+int tlsf_init_file(const char* path, size_t size) {
+    pthread_mutex_lock(&pool_lock);
+    release_pool();
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        pthread_mutex_unlock(&pool_lock);
+        return -1;
+    }
+
+    int result = -1;
+    int reformat = 1;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        size_t length = (size_t) st.st_size;
+        void* map = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            reformat = 0;  // Filen kan vara hel, den skrivs inte över
+        } else if (valid_header((TlsfFileHeader*) map, length)) {
+            attach_file((TlsfFileHeader*) map);
+            if (check_pool() == 0) {
+                result = file_header->clean ? 1 : 2;
+                reformat = 0;
+            }
+        }
+        if (reformat) {
+            // En skadad pool skrivs inte tillbaka som ren, den skapas om från början
+            mem_report(MEM_ERR_POOL_CORRUPT, map);
+            munmap(map, length);
+            detach_file();
+            size = size ? size : length;
+        }
+    }
+    if (reformat) {
+        result = format_file(fd, size);
+    }
+    close(fd);
+
+    if (result >= 0) {
+        // Poolen är i bruk tills mem_deinit märker den som ren igen. Ingen annan process
+        // använder filen, så låset från förra körningen kan skapas om.
+        init_header_lock(file_header);
+        file_header->clean = 0;
+        msync(file_header, sizeof(TlsfFileHeader), MS_SYNC);
+    } else {
+        release_pool();
+    }
+    pthread_mutex_unlock(&pool_lock);
+    return result;
+}
+
+// Vänta tills processen som skapade poolen har formaterat den och mappa den sedan
+static int attach_shared(int fd) {
+    struct timespec pause = {0, 1000000};
+    for (int attempt = 0; attempt < 5000; attempt++) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            return -1;
+        }
+        size_t length = (size_t) st.st_size;
+        if (length >= sizeof(TlsfFileHeader)) {
+            void* map = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (map == MAP_FAILED) {
+                return -1;
+            }
+            TlsfFileHeader* header = (TlsfFileHeader*) map;
+            if (atomic_load(&header->ready)) {
+                if (!valid_header(header, length)) {
+                    munmap(map, length);
+                    return -1;
+                }
+                attach_file(header);
+                return 1;
+            }
+            munmap(map, length);
+        }
+        nanosleep(&pause, NULL);
+    }
+    return -1;
+}
+
+int tlsf_init_shared(const char* name, size_t size) {
+    pthread_mutex_lock(&pool_lock);
+    release_pool();
+
+    // Den första processen skapar och formaterar objektet, de andra ansluter till det
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    int result;
+    if (fd >= 0) {
+        result = format_file(fd, size);
+        if (result == 0) {
+            init_header_lock(file_header);
+        }
+    } else if (errno == EEXIST && (fd = shm_open(name, O_RDWR, 0600)) >= 0) {
+        result = attach_shared(fd);
+    } else {
+        pthread_mutex_unlock(&pool_lock);
+        return -1;
+    }
+    close(fd);
+
+    if (result >= 0) {
+        pool_shared = 1;
+    } else {
+        release_pool();
+    }
+    pthread_mutex_unlock(&pool_lock);
+    return result;
+}
+
+int tlsf_set_root(void* ptr) {
+    lock_pool();
+    int result = -1;
+    if (file_header != NULL && ptr == NULL) {
+        file_header->root = 0;
+        result = 0;
+    } else if (file_header != NULL && block_of(ptr) != SIZE_MAX) {
+        file_header->root = (uint64_t) ((char*) ptr - pool_start) + 1;
+        result = 0;
+    }
+    unlock_pool();
+    return result;
+}
+
+void* tlsf_root(void) {
+    lock_pool();
+    void* root = file_header != NULL && file_header->root != 0 ? pool_start + file_header->root - 1 : NULL;
+    unlock_pool();
+    return root;
+}
+
+const MemBackend mm_tlsf_backend = {
+    "tlsf", tlsf_init, tlsf_init_growable, tlsf_alloc, tlsf_alloc_contiguous, tlsf_free,
+    tlsf_free_batch, tlsf_resize, tlsf_reserve, tlsf_pool_base, tlsf_deinit, NULL, NULL, NULL,
+    tlsf_usable_size
+};
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "memory_manager.h"
+#include "epoch.h"
+#include "rcu_list.h"
+
+// Läsare laddar pekare med acquire så att de ser noden som den publicerades.
+// Skrivare publicerar med release först när noden är helt ifylld.
+static inline RcuNode* load_link(RcuNode* _Atomic* link) {
+    return atomic_load_explicit(link, memory_order_acquire);
+}
+
+static inline void publish(RcuNode* _Atomic* link, RcuNode* node) {
+    atomic_store_explicit(link, node, memory_order_release);
+}
+
+// Skrivare ser alltid den senaste versionen, de håller låset
+static inline RcuNode* writer_link(RcuNode* _Atomic* link) {
+    return atomic_load_explicit(link, memory_order_relaxed);
+}
+
+// Anropas med skrivlåset taget. Är poolen full kan det bero på noder som väntar
+// på en grace period, då väntar skrivaren ut den och försöker igen.
+static RcuNode* new_node(uint16_t data, RcuNode* next) {
+    RcuNode* node = (RcuNode*) mem_alloc(sizeof(RcuNode));
+    if (!node && ebr_pending() > 0) {
+        ebr_synchronize();
+        node = (RcuNode*) mem_alloc(sizeof(RcuNode));
+    }
+    if (!node) {
+        mem_report(MEM_ERR_OUT_OF_MEMORY, NULL);
+        return NULL;
+    }
+    node->data = data;
+    atomic_store_explicit(&node->next, next, memory_order_relaxed);
+    return node;
+}
+
+// Hitta länken som pekar på den första noden med värdet, anropas med skrivlåset taget.
+// *prev_out blir noden som äger länken, NULL om det är huvudet.
+static RcuNode* _Atomic* find_link(RcuList* list, uint16_t data, RcuNode** prev_out) {
+    RcuNode* _Atomic* link = &list->head;
+    RcuNode* prev = NULL;
+    RcuNode* current;
+    while ((current = writer_link(link)) != NULL && current->data != data) {
+        prev = current;
+        link = &current->next;
+    }
+    *prev_out = prev;
+    return current ? link : NULL;
+}
+
+// The function sets up the list and the pool its nodes are taken from
+void rcu_list_init(RcuList* list, size_t size) {
+    atomic_store(&list->head, NULL);
+    list->tail = NULL;
+    pthread_mutex_init(&list->writer_lock, NULL);
+    mem_init(size);
+}
+
+int rcu_list_insert(RcuList* list, uint16_t data) {
+    pthread_mutex_lock(&list->writer_lock);
+    RcuNode* node = new_node(data, NULL);
+    if (node) {
+        publish(list->tail ? &list->tail->next : &list->head, node);
+        list->tail = node;
+    }
+    pthread_mutex_unlock(&list->writer_lock);
+    return node ? 0 : -1;
+}
+
+int rcu_list_insert_front(RcuList* list, uint16_t data) {
+    pthread_mutex_lock(&list->writer_lock);
+    RcuNode* node = new_node(data, writer_link(&list->head));
+    if (node) {
+        publish(&list->head, node);
+        if (list->tail == NULL) {
+            list->tail = node;
+        }
+    }
+    pthread_mutex_unlock(&list->writer_lock);
+    return node ? 0 : -1;
+}
+
+// Tar bort den första noden med värdet. Läsare som redan står på noden kan
+// fortsätta förbi den, den frigörs först efter en grace period.
+int rcu_list_delete(RcuList* list, uint16_t data) {
+    pthread_mutex_lock(&list->writer_lock);
+    RcuNode* prev;
+    RcuNode* _Atomic* link = find_link(list, data, &prev);
+    if (link == NULL) {
+        pthread_mutex_unlock(&list->writer_lock);
+        return 0;
+    }
+
+    RcuNode* node = writer_link(link);
+    publish(link, writer_link(&node->next));
+    if (list->tail == node) {
+        list->tail = prev;
+    }
+    pthread_mutex_unlock(&list->writer_lock);
+
+    ebr_retire(node);
+    return 1;
+}
+
+// Byter värde genom att ersätta noden med en kopia, så att en läsare
+// aldrig ser en nod som ändras under tiden den läses
+int rcu_list_replace(RcuList* list, uint16_t old_data, uint16_t new_data) {
+    pthread_mutex_lock(&list->writer_lock);
+    RcuNode* prev;
+    RcuNode* _Atomic* link = find_link(list, old_data, &prev);
+    if (link == NULL) {
+        pthread_mutex_unlock(&list->writer_lock);
+        return 0;
+    }
+
+    RcuNode* old_node = writer_link(link);
+    RcuNode* copy = new_node(new_data, writer_link(&old_node->next));
+    if (!copy) {
+        pthread_mutex_unlock(&list->writer_lock);
+        return -1;
+    }
+    publish(link, copy);
+    if (list->tail == old_node) {
+        list->tail = copy;
+    }
+    pthread_mutex_unlock(&list->writer_lock);
+
+    ebr_retire(old_node);
+    return 1;
+}
+
+int rcu_list_contains(RcuList* list, uint16_t data) {
+    int found = 0;
+    ebr_enter();
+    for (RcuNode* current = load_link(&list->head); current != NULL; current = load_link(&current->next)) {
+        if (current->data == data) {
+            found = 1;
+            break;
+        }
+    }
+    ebr_exit();
+    return found;
+}
+
+size_t rcu_list_count_nodes(RcuList* list) {
+    size_t count = 0;
+    ebr_enter();
+    for (RcuNode* current = load_link(&list->head); current != NULL; current = load_link(&current->next)) {
+        count++;
+    }
+    ebr_exit();
+    return count;
+}
+
+// Besöker listan som den såg ut någon gång under anropet, returnerar antalet besökta noder
+size_t rcu_list_for_each(RcuList* list, RcuVisitFn fn, void* ctx) {
+    size_t count = 0;
+    ebr_enter();
+    for (RcuNode* current = load_link(&list->head); current != NULL; current = load_link(&current->next)) {
+        fn(current->data, ctx);
+        count++;
+    }
+    ebr_exit();
+    return count;
+}
+
+// Får bara anropas när inga andra trådar använder listan
+void rcu_list_cleanup(RcuList* list) {
+    RcuNode* current = writer_link(&list->head);
+    while (current != NULL) {
+        RcuNode* next_node = writer_link(&current->next);
+        mem_free(current);
+        current = next_node;
+    }
+    atomic_store(&list->head, NULL);
+    list->tail = NULL;
+    pthread_mutex_destroy(&list->writer_lock);
+
+    ebr_drain();   // Frigör noder som väntar på en grace period
+    mem_deinit();  // Avslutar minneshanteraren
+}
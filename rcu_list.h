@@ -0,0 +1,39 @@
+#ifndef RCU_LIST_H
+#define RCU_LIST_H
+#include <stddef.h>  // For size_t
+#include <stdint.h>  // For uint16_t
+#include <stdatomic.h>
+#include <pthread.h>
+
+// Read-mostly list in the style of RCU. Readers never block and never write to
+// shared memory other than their own epoch slot: no locks and no atomic
+// read-modify-write operations. Writers are serialized by a mutex, publish
+// fully built nodes with a single release store, and hand unlinked nodes to
+// epoch.h, which returns them to the memory manager after a grace period.
+
+typedef struct RcuNode {
+    uint16_t data;
+    struct RcuNode* _Atomic next;
+} RcuNode;
+
+typedef struct RcuList {
+    RcuNode* _Atomic head;
+    RcuNode* tail;                 // Only touched by writers
+    pthread_mutex_t writer_lock;   // Serializes all updates
+} RcuList;
+
+// Called for every value seen by rcu_list_for_each
+typedef void (*RcuVisitFn)(uint16_t data, void* ctx);
+
+// Function prototypes
+void rcu_list_init(RcuList* list, size_t size);
+int rcu_list_insert(RcuList* list, uint16_t data);
+int rcu_list_insert_front(RcuList* list, uint16_t data);
+int rcu_list_delete(RcuList* list, uint16_t data);
+int rcu_list_replace(RcuList* list, uint16_t old_data, uint16_t new_data);
+int rcu_list_contains(RcuList* list, uint16_t data);
+size_t rcu_list_count_nodes(RcuList* list);
+size_t rcu_list_for_each(RcuList* list, RcuVisitFn fn, void* ctx);
+void rcu_list_cleanup(RcuList* list);
+
+#endif  // RCU_LIST_H
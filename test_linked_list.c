@@ -1,9 +1,19 @@
 #include "linked_list.h"
+#include "memory_manager.h"
+#include "lf_list.h"
+#include "compact_list.h"
+#include "list_parallel.h"
+#include "generic_list.h"
+#include "rcu_list.h"
+#include "epoch.h"
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
 #include <time.h>
 #include <stddef.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/wait.h>
 
 #include "common_defs.h"
 #include "gitdata.h"
@@ -483,7 +493,1138 @@ void test_list_edge_cases()
     printf_green("[PASS].\n");
 }
 
+void test_list_insert_array(int count)
+{
+    printf_yellow("  Testing list_insert_array ---> ");
+    Node *head = NULL;
+    list_init(&head, sizeof(Node) * (count + 1));
+    list_insert(&head, 12345);
+
+    uint16_t values[count];
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = i;
+    }
+    list_insert_array(&head, values, count);
+    my_assert(list_count_nodes(&head) == count + 1);
+
+    // The appended nodes must be physically sequential
+    Node *first = head->next;
+    Node *current = first;
+    for (int i = 0; i < count; i++)
+    {
+        my_assert(current == first + i);
+        my_assert(current->data == i);
+        current = current->next;
+    }
+    my_assert(current == NULL);
+
+    // Nodes in the run can still be released one by one
+    list_delete(&head, count / 2);
+    my_assert(list_search(&head, count / 2) == NULL);
+    list_insert(&head, count / 2);
+    my_assert(list_count_nodes(&head) == count + 1);
+
+    list_cleanup(&head);
+    printf_green("[PASS].\n");
+}
+
+void test_list_from_array(int count)
+{
+    printf_yellow("  Testing list_from_array ---> ");
+    Node *head = NULL;
+
+    uint16_t values[count];
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = count - i;
+    }
+    list_from_array(&head, values, count);
+
+    Node *current = head;
+    for (int i = 0; i < count; i++)
+    {
+        my_assert(current == head + i);
+        my_assert(current->data == count - i);
+        current = current->next;
+    }
+
+    // The pool is sized exactly for the array
+    list_insert(&head, 1);
+    my_assert(list_count_nodes(&head) == count);
+
+    for (int i = 0; i < count; i++)
+    {
+        list_delete(&head, count - i);
+    }
+    my_assert(head == NULL);
+
+    list_cleanup(&head);
+    printf_green("[PASS].\n");
+}
+
+void test_list_format(int count)
+{
+    printf_yellow("  Testing list_format and list_write ---> ");
+    Node *head = NULL;
+
+    uint16_t values[count];
+    char *expected = malloc(count * 8 + 3);
+    size_t pos = sprintf(expected, "[");
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = (uint16_t)(i * 7919);
+        pos += sprintf(expected + pos, "%u%s", values[i], i < count - 1 ? ", " : "]");
+    }
+    list_from_array(&head, values, count);
+
+    // Formatting into a buffer that fits
+    size_t len = strlen(expected);
+    char *buffer = malloc(len + 1);
+    my_assert(list_format(&head, buffer, len + 1) == len);
+    my_assert(strcmp(buffer, expected) == 0);
+
+    // Truncated output still reports the full length
+    char small[8];
+    my_assert(list_format(&head, small, sizeof(small)) == len);
+    my_assert(strncmp(small, expected, sizeof(small) - 1) == 0);
+    my_assert(small[sizeof(small) - 1] == '\0');
+
+    // Writing to a file descriptor
+    FILE *fp = tmpfile();
+    my_assert(fp != NULL);
+    my_assert(list_write(&head, fileno(fp)) == 0);
+    rewind(fp);
+    memset(buffer, 0, len + 1);
+    my_assert(fread(buffer, 1, len, fp) == len);
+    my_assert(strcmp(buffer, expected) == 0);
+    fclose(fp);
+
+    // An empty list
+    Node *empty = NULL;
+    my_assert(list_format(&empty, small, sizeof(small)) == 2);
+    my_assert(strcmp(small, "[]") == 0);
+
+    list_cleanup(&head);
+    free(buffer);
+    free(expected);
+    printf_green("[PASS].\n");
+}
+
+void test_list_snapshot(int count)
+{
+    printf_yellow("  Testing list_save and list_load ---> ");
+    char path[] = "/tmp/test_list_snapshot_XXXXXX";
+    int fd = mkstemp(path);
+    my_assert(fd >= 0);
+    close(fd);
+
+    Node *head = NULL;
+    uint16_t *values = malloc(count * sizeof(uint16_t));
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = (uint16_t)rand();
+    }
+    list_from_array(&head, values, count);
+    my_assert(list_save(&head, path) == 0);
+    list_cleanup(&head);
+
+    // Reload and compare value by value
+    my_assert(list_load(&head, path) == 0);
+    Node *current = head;
+    for (int i = 0; i < count; i++)
+    {
+        my_assert(current != NULL);
+        my_assert(current->data == values[i]);
+        current = current->next;
+    }
+    my_assert(current == NULL);
+    list_cleanup(&head);
+
+    // A truncated snapshot must be rejected
+    my_assert(truncate(path, 24 + count) == 0);
+    my_assert(list_load(&head, path) == -1);
+    my_assert(head == NULL);
+
+    // So must a file that is not a snapshot at all
+    FILE *fp = fopen(path, "w");
+    fprintf(fp, "[1, 2, 3]");
+    fclose(fp);
+    my_assert(list_load(&head, path) == -1);
+
+    unlink(path);
+    free(values);
+    printf_green("[PASS].\n");
+}
+
+static int is_odd(uint16_t data, void *ctx)
+{
+    (void)ctx;
+    return data & 1;
+}
+
+static int below_limit(uint16_t data, void *ctx)
+{
+    return data < *(uint16_t *)ctx;
+}
+
+void test_list_delete_all(int count)
+{
+    printf_yellow("  Testing list_delete_all ---> ");
+    Node *head = NULL;
+    uint16_t values[count];
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = i % 3 == 0 ? 7 : i;
+    }
+    list_from_array(&head, values, count);
+
+    size_t sevens = 0;
+    for (int i = 0; i < count; i++)
+    {
+        sevens += values[i] == 7;
+    }
+    my_assert(list_delete_all(&head, 7) == sevens);
+    my_assert(list_search(&head, 7) == NULL);
+    my_assert(list_count_nodes(&head) == count - (int)sevens);
+    my_assert(list_delete_all(&head, 7) == 0);
+
+    // The freed nodes were coalesced and can be allocated again
+    for (size_t i = 0; i < sevens; i++)
+    {
+        list_insert(&head, 7);
+    }
+    my_assert(list_count_nodes(&head) == count);
+
+    list_cleanup(&head);
+    printf_green("[PASS].\n");
+}
+
+void test_list_remove_if(int count)
+{
+    printf_yellow("  Testing list_remove_if and list_retain_if ---> ");
+    Node *head = NULL;
+    uint16_t values[count];
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = (uint16_t)rand();
+    }
+    list_from_array(&head, values, count);
+
+    int odd = 0;
+    for (int i = 0; i < count; i++)
+    {
+        odd += values[i] & 1;
+    }
+    my_assert(list_remove_if(&head, is_odd, NULL) == (size_t)odd);
+
+    // Order of the remaining values is preserved
+    Node *current = head;
+    for (int i = 0; i < count; i++)
+    {
+        if (!(values[i] & 1))
+        {
+            my_assert(current->data == values[i]);
+            current = current->next;
+        }
+    }
+    my_assert(current == NULL);
+
+    uint16_t limit = 1000;
+    int kept = 0;
+    for (int i = 0; i < count; i++)
+    {
+        kept += !(values[i] & 1) && values[i] < limit;
+    }
+    list_retain_if(&head, below_limit, &limit);
+    my_assert(list_count_nodes(&head) == kept);
+
+    // Removing everything empties the list
+    list_retain_if(&head, is_odd, NULL);
+    my_assert(head == NULL);
+
+    list_cleanup(&head);
+    printf_green("[PASS].\n");
+}
+
+void test_list_sort(int count)
+{
+    printf_yellow("  Testing list_sort ---> ");
+    Node *head = NULL;
+    uint16_t values[count];
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = (uint16_t)(rand() % 100);
+    }
+    list_from_array(&head, values, count);
+
+    // Remember the original position of each node to check stability
+    Node *first = head;
+    list_sort(&head);
+    my_assert(list_is_sorted(&head));
+    my_assert(list_count_nodes(&head) == count);
+
+    Node *current = head;
+    while (current->next != NULL)
+    {
+        if (current->data == current->next->data)
+        {
+            my_assert(current < current->next);
+        }
+        current = current->next;
+    }
+
+    // Sorting is done in place: the same nodes are reused
+    my_assert(list_search(&head, values[0]) >= first);
+
+    // Empty and single node lists
+    Node *empty = NULL;
+    list_sort(&empty);
+    my_assert(empty == NULL);
+
+    list_cleanup(&head);
+    printf_green("[PASS].\n");
+}
+
+void test_list_sorted_mode(int count)
+{
+    printf_yellow("  Testing list_insert_sorted and list_merge ---> ");
+    Node *head = NULL;
+    Node *other = NULL;
+    list_init(&head, sizeof(Node) * count * 2);
+
+    for (int i = 0; i < count; i++)
+    {
+        list_insert_sorted(&head, (uint16_t)(rand() % 1000));
+        list_insert_sorted(&other, (uint16_t)(rand() % 1000));
+    }
+    my_assert(list_is_sorted(&head));
+    my_assert(list_is_sorted(&other));
+
+    list_merge(&head, &other);
+    my_assert(other == NULL);
+    my_assert(list_is_sorted(&head));
+    my_assert(list_count_nodes(&head) == count * 2);
+
+    list_cleanup(&head);
+    printf_green("[PASS].\n");
+}
+
+void test_list_iterator(int count)
+{
+    printf_yellow("  Testing list iterators ---> ");
+    Node *head = NULL;
+    uint16_t values[count];
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = (uint16_t)(i * 3);
+    }
+    list_from_array(&head, values, count);
+
+    // Manual cursor
+    ListIter it = list_iter_begin(&head);
+    Node *node;
+    int i = 0;
+    while ((node = list_iter_next(&it)) != NULL)
+    {
+        my_assert(node->data == values[i]);
+        i++;
+    }
+    my_assert(i == count);
+    my_assert(list_iter_next(&it) == NULL);
+
+    // Foreach with break
+    i = 0;
+    LIST_FOREACH(current, &head)
+    {
+        if (i == count / 2)
+        {
+            break;
+        }
+        my_assert(current->data == values[i]);
+        i++;
+    }
+    my_assert(i == count / 2);
+
+    // Batches
+    uint16_t batch[64];
+    size_t got, total = 0;
+    it = list_iter_begin(&head);
+    while ((got = list_iter_next_batch(&it, batch, 64)) > 0)
+    {
+        for (size_t k = 0; k < got; k++)
+        {
+            my_assert(batch[k] == values[total + k]);
+        }
+        total += got;
+    }
+    my_assert(total == (size_t)count);
+
+    // An empty list
+    Node *empty = NULL;
+    LIST_FOREACH(current, &empty)
+    {
+        my_assert(current == NULL);
+    }
+
+    list_cleanup(&head);
+    printf_green("[PASS].\n");
+}
+
+void test_list_compact(int count)
+{
+    printf_yellow("  Testing node relayout ---> ");
+    Node *head = NULL;
+    list_init(&head, 2 * count * sizeof(Node));
+
+    // Sorting shuffled input leaves the nodes scattered over the pool
+    unsigned int seed = 3;
+    for (int i = 0; i < count; i++)
+    {
+        list_insert(&head, (uint16_t)(rand_r(&seed) % 60000));
+    }
+    my_assert(list_disorder(&head) < 0.01);
+    list_sort(&head);
+    my_assert(list_disorder(&head) > 0.5);
+
+    // Incremental passes never leave the list in a broken state
+    ListCompactor compactor;
+    list_compact_begin(&compactor, &head);
+    int steps = 0;
+    while (list_compact_step(&compactor, 100) > 0)
+    {
+        steps++;
+        my_assert(list_count_nodes(&head) == count);
+    }
+    my_assert(steps >= count / 100);
+    my_assert(list_is_sorted(&head));
+    my_assert(list_disorder(&head) < 0.05);
+
+    // A second pass finds nothing to move
+    list_compact(&head);
+    my_assert(list_count_nodes(&head) == count);
+    my_assert(list_is_sorted(&head));
+    list_cleanup(&head);
+
+    // The list may change between steps, even the nodes just compacted
+    list_init(&head, 2 * count * sizeof(Node));
+    for (int i = 0; i < count; i++)
+    {
+        list_insert(&head, (uint16_t)(rand_r(&seed) % 60000));
+    }
+    list_sort(&head);
+    list_compact_begin(&compactor, &head);
+    int expected = count;
+    my_assert(list_compact_step(&compactor, 100) > 0);
+    while (head != NULL && list_compact_step(&compactor, 100) > 0)
+    {
+        list_delete(&head, head->data);
+        list_delete(&head, head->data);
+        list_insert_sorted(&head, 0);
+        expected--;
+        my_assert(list_count_nodes(&head) == expected);
+    }
+    my_assert(list_is_sorted(&head));
+    my_assert(list_disorder(&head) < 0.05);
+    list_cleanup(&head);
+
+    // Inserts between steps keep the saved position; appended nodes are compacted too
+    list_init(&head, 3 * count * sizeof(Node));
+    for (int i = 0; i < count; i++)
+    {
+        list_insert(&head, (uint16_t)(rand_r(&seed) % 60000));
+    }
+    list_sort(&head);
+    list_compact_begin(&compactor, &head);
+    expected = count;
+    while (list_compact_step(&compactor, 100) > 0)
+    {
+        if (expected < 2 * count)
+        {
+            list_insert(&head, 60000);
+            expected++;
+        }
+    }
+    my_assert(list_count_nodes(&head) == expected);
+    my_assert(list_is_sorted(&head));
+    my_assert(list_disorder(&head) < 0.05);
+    list_cleanup(&head);
+
+    // Without free space in the pool the list is left as it is
+    uint16_t values[4] = {4, 3, 2, 1};
+    list_init(&head, 4 * sizeof(Node));
+    list_insert_array(&head, values, 4);
+    list_sort(&head);
+    list_compact(&head);
+    my_assert(list_count_nodes(&head) == 4 && list_is_sorted(&head));
+
+    Node *empty = NULL;
+    my_assert(list_disorder(&empty) == 0.0);
+    list_compact(&empty);
+    my_assert(empty == NULL);
+
+    list_cleanup(&head);
+    printf_green("[PASS].\n");
+}
+
+void test_list_growable(int count)
+{
+    printf_yellow("  Testing auto-growing list capacity ---> ");
+    Node *head = NULL;
+    list_init_growable(&head, sizeof(Node), 0);
+
+    list_insert(&head, 0);
+    Node *first = head;
+    uint16_t values[count];
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = (uint16_t)(i + 1);
+    }
+    list_insert_array(&head, values, count);
+
+    // The pool grew many times, but the first node never moved
+    my_assert(head == first && head->data == 0);
+    my_assert(list_count_nodes(&head) == count + 1);
+
+    // After a reservation, inserts are served from what is already there
+    my_assert(list_reserve(&head, count) == 0);
+    for (int i = 0; i < count; i++)
+    {
+        list_insert_after(first, (uint16_t)i);
+    }
+    my_assert(list_count_nodes(&head) == 2 * count + 1);
+    list_cleanup(&head);
+
+    // The limit given at init is respected
+    list_init_growable(&head, sizeof(Node), 4096);
+    my_assert(list_reserve(&head, 4096 / sizeof(Node)) == 0);
+    my_assert(list_reserve(&head, 4096 / sizeof(Node) + 1) == -1);
+    list_cleanup(&head);
+    printf_green("[PASS].\n");
+}
+
+static void sum_visit(Node *node, void *ctx)
+{
+    *(uint64_t *)ctx += node->data;
+}
+
+void test_list_to_array(int count)
+{
+    printf_yellow("  Testing export to arrays and range callbacks ---> ");
+    Node *head = NULL;
+    uint16_t values[count];
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = (uint16_t)(i * 7);
+    }
+    list_from_array(&head, values, count);
+
+    // The whole list, and a buffer that is too small
+    uint16_t out[count + 1];
+    my_assert(list_to_array(&head, out, count + 1) == (size_t)count);
+    my_assert(memcmp(out, values, count * sizeof(uint16_t)) == 0);
+    my_assert(list_to_array(&head, out, 10) == 10);
+
+    // An inclusive range in the middle, and one that runs to the end
+    Node *start = list_search(&head, values[10]);
+    Node *end = list_search(&head, values[19]);
+    my_assert(list_range_to_array(start, end, out, count) == 10);
+    my_assert(memcmp(out, values + 10, 10 * sizeof(uint16_t)) == 0);
+    my_assert(list_range_to_array(end, NULL, out, count) == (size_t)count - 19);
+    my_assert(list_range_to_array(start, start, out, count) == 1 && out[0] == values[10]);
+
+    uint64_t sum = 0;
+    my_assert(list_for_each_range(start, end, sum_visit, &sum) == 10);
+    uint64_t expected = 0;
+    for (int i = 10; i < 20; i++)
+    {
+        expected += values[i];
+    }
+    my_assert(sum == expected);
+
+    Node *empty = NULL;
+    my_assert(list_to_array(&empty, out, count) == 0);
+    my_assert(list_for_each_range(NULL, NULL, sum_visit, &sum) == 0);
+
+    list_cleanup(&head);
+    printf_green("[PASS].\n");
+}
+
+// ********* Concurrent lists *********
+
+#define LF_STRESS_KEYS 2048
+
+typedef struct
+{
+    LfList *list;
+    int id;
+    int nthreads;
+    int ops;
+    char present[LF_STRESS_KEYS];
+} LfStressArgs;
+
+// Each thread mutates only the keys it owns, so it can track their expected
+// state, but searches every key so that traversals race with all writers.
+static void *lf_stress_worker(void *arg)
+{
+    LfStressArgs *a = (LfStressArgs *)arg;
+    unsigned int seed = (unsigned int)time(NULL) ^ (a->id * 2654435761u);
+
+    for (int i = 0; i < a->ops; i++)
+    {
+        int r = rand_r(&seed);
+        uint16_t key = (uint16_t)((r >> 4) % LF_STRESS_KEYS);
+        uint16_t own = (uint16_t)(key - key % a->nthreads + a->id);
+        if (own >= LF_STRESS_KEYS)
+        {
+            own = (uint16_t)a->id;
+        }
+
+        switch (r & 3)
+        {
+        case 0:
+            my_assert(lf_list_insert(a->list, own) == !a->present[own]);
+            a->present[own] = 1;
+            break;
+        case 1:
+            my_assert(lf_list_delete(a->list, own) == a->present[own]);
+            a->present[own] = 0;
+            break;
+        case 2:
+            my_assert(lf_list_contains(a->list, own) == a->present[own]);
+            break;
+        default:
+            lf_list_contains(a->list, key);
+            break;
+        }
+    }
+    return NULL;
+}
+
+void test_lf_list_stress(int nthreads, int ops)
+{
+    printf_yellow("  Testing lock-free list with %d threads ---> ", nthreads);
+    LfList list;
+    lf_list_init(&list, sizeof(LfNode) * LF_STRESS_KEYS * 16);
+
+    pthread_t threads[nthreads];
+    LfStressArgs *args = calloc(nthreads, sizeof(LfStressArgs));
+    for (int t = 0; t < nthreads; t++)
+    {
+        args[t].list = &list;
+        args[t].id = t;
+        args[t].nthreads = nthreads;
+        args[t].ops = ops;
+        my_assert(pthread_create(&threads[t], NULL, lf_stress_worker, &args[t]) == 0);
+    }
+    for (int t = 0; t < nthreads; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    // Every key must match the state its owner expects
+    size_t expected = 0;
+    for (int t = 0; t < nthreads; t++)
+    {
+        for (int k = t; k < LF_STRESS_KEYS; k += nthreads)
+        {
+            my_assert(lf_list_contains(&list, k) == args[t].present[k]);
+            expected += args[t].present[k];
+        }
+    }
+    my_assert(lf_list_count_nodes(&list) == expected);
+
+    // The list must still be strictly sorted
+    int last = -1;
+    LfNode *current = (LfNode *)(atomic_load(&list.head) & ~(uintptr_t)1);
+    while (current != NULL)
+    {
+        uintptr_t next = atomic_load(&current->next);
+        if (!(next & 1))
+        {
+            my_assert(current->data > last);
+            last = current->data;
+        }
+        current = (LfNode *)(next & ~(uintptr_t)1);
+    }
+
+    lf_list_cleanup(&list);
+    free(args);
+    printf_green("[PASS].\n");
+}
+
+void test_lf_list_alignment(int count)
+{
+    printf_yellow("  Testing lock-free list after odd-sized allocations ---> ");
+    LfList list;
+    lf_list_init(&list, sizeof(LfNode) * count * 4);
+
+    // Odd sizes first, so a pool without alignment would hand out odd node addresses
+    void *odd[3] = {mem_alloc(3), mem_alloc(5), mem_alloc(7)};
+    for (int i = 0; i < 3; i++)
+    {
+        my_assert(odd[i] != NULL);
+        my_assert((uintptr_t)odd[i] % _Alignof(max_align_t) == 0);
+    }
+
+    // Bit 0 of next is the deletion mark, every node must leave it clear
+    for (int i = 0; i < count; i++)
+    {
+        my_assert(lf_list_insert(&list, (uint16_t)(i * 3)) == 1);
+    }
+    for (uintptr_t node = atomic_load(&list.head); node != 0;
+         node = atomic_load(&((LfNode *)node)->next) & ~(uintptr_t)1)
+    {
+        my_assert(node % _Alignof(LfNode) == 0);
+    }
+    for (int i = 0; i < count; i += 2)
+    {
+        my_assert(lf_list_delete(&list, (uint16_t)(i * 3)) == 1);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        my_assert(lf_list_contains(&list, (uint16_t)(i * 3)) == (i % 2));
+    }
+    my_assert(lf_list_count_nodes(&list) == (size_t)count / 2);
+
+    for (int i = 0; i < 3; i++)
+    {
+        mem_free(odd[i]);
+    }
+    lf_list_cleanup(&list);
+    printf_green("[PASS].\n");
+}
+
+// ********* Read-mostly lists *********
+
+#define RCU_STRESS_KEYS 256
+
+typedef struct
+{
+    RcuList *list;
+    int ops;
+    _Atomic int *stop;
+} RcuStressArgs;
+
+static void rcu_sum_visit(uint16_t data, void *ctx)
+{
+    *(uint64_t *)ctx += data;
+}
+
+// Even keys are never touched by the writer, so readers must always see them
+static void *rcu_stress_reader(void *arg)
+{
+    RcuStressArgs *a = (RcuStressArgs *)arg;
+    unsigned int seed = (unsigned int)(uintptr_t)a;
+    while (!atomic_load(a->stop))
+    {
+        uint16_t key = (uint16_t)(rand_r(&seed) % RCU_STRESS_KEYS & ~1);
+        my_assert(rcu_list_contains(a->list, key));
+        my_assert(rcu_list_count_nodes(a->list) >= RCU_STRESS_KEYS / 2);
+        uint64_t sum = 0;
+        my_assert(rcu_list_for_each(a->list, rcu_sum_visit, &sum) >= RCU_STRESS_KEYS / 2);
+    }
+    return NULL;
+}
+
+// Odd keys are deleted, reinserted and replaced while the readers run
+static void *rcu_stress_writer(void *arg)
+{
+    RcuStressArgs *a = (RcuStressArgs *)arg;
+    unsigned int seed = 99;
+    for (int i = 0; i < a->ops; i++)
+    {
+        uint16_t key = (uint16_t)(rand_r(&seed) % RCU_STRESS_KEYS | 1);
+        switch (i % 3)
+        {
+        case 0:
+            if (rcu_list_delete(a->list, key))
+            {
+                my_assert(rcu_list_insert(a->list, key) == 0);
+            }
+            break;
+        case 1:
+            if (rcu_list_delete(a->list, key))
+            {
+                my_assert(rcu_list_insert_front(a->list, key) == 0);
+            }
+            break;
+        default:
+            rcu_list_replace(a->list, key, key);
+            break;
+        }
+    }
+    atomic_store(a->stop, 1);
+    return NULL;
+}
+
+void test_rcu_list_stress(int nreaders, int ops)
+{
+    printf_yellow("  Testing read-mostly list with %d readers ---> ", nreaders);
+    RcuList list;
+    rcu_list_init(&list, sizeof(RcuNode) * RCU_STRESS_KEYS * 8);
+    for (int k = 0; k < RCU_STRESS_KEYS; k++)
+    {
+        my_assert(rcu_list_insert(&list, k) == 0);
+    }
+
+    // Single-threaded semantics
+    my_assert(rcu_list_delete(&list, 1) == 1 && rcu_list_delete(&list, 1) == 0);
+    my_assert(rcu_list_replace(&list, RCU_STRESS_KEYS - 1, 1) == 1);
+    my_assert(rcu_list_contains(&list, 1) && !rcu_list_contains(&list, RCU_STRESS_KEYS - 1));
+    my_assert(rcu_list_replace(&list, 1, RCU_STRESS_KEYS - 1) == 1);
+    my_assert(rcu_list_insert(&list, 1) == 0);
+    my_assert(rcu_list_count_nodes(&list) == RCU_STRESS_KEYS);
+
+    _Atomic int stop = 0;
+    RcuStressArgs args = {&list, ops, &stop};
+    pthread_t readers[nreaders];
+    pthread_t writer;
+    for (int t = 0; t < nreaders; t++)
+    {
+        my_assert(pthread_create(&readers[t], NULL, rcu_stress_reader, &args) == 0);
+    }
+    my_assert(pthread_create(&writer, NULL, rcu_stress_writer, &args) == 0);
+    pthread_join(writer, NULL);
+    for (int t = 0; t < nreaders; t++)
+    {
+        pthread_join(readers[t], NULL);
+    }
+
+    // Every key is back, and deferred frees have all been returned to the pool
+    my_assert(rcu_list_count_nodes(&list) == RCU_STRESS_KEYS);
+    for (int k = 0; k < RCU_STRESS_KEYS; k++)
+    {
+        my_assert(rcu_list_contains(&list, k));
+    }
+    // The writer has exited, so a grace period frees what it left behind
+    ebr_synchronize();
+    my_assert(ebr_pending() == 0);
+    rcu_list_cleanup(&list);
+    my_assert(ebr_pending() == 0);
+    printf_green("[PASS].\n");
+}
+
+// ********* Compact lists *********
+
+// Pool bytes that hold one block of the given size. The buddy backend only
+// hands out power-of-two blocks, so there the size is rounded up.
+static size_t pool_bytes_for(size_t bytes)
+{
+    if (strcmp(mem_backend_name(), "buddy") != 0)
+    {
+        return bytes;
+    }
+    size_t room = 16;
+    while (room < bytes)
+    {
+        room *= 2;
+    }
+    return room;
+}
+
+void test_clist_operations()
+{
+    printf_yellow("  Testing compact list operations ---> ");
+    CList list;
+    clist_init(&list, sizeof(CNode) * 4);
+
+    clist_insert(&list, 10);
+    clist_insert(&list, 30);
+    my_assert(clist_node(list.head)->data == 10);
+
+    // Insert after and before
+    CNodeRef ten = clist_search(&list, 10);
+    clist_insert_after(&list, ten, 20);
+    CNodeRef thirty = clist_search(&list, 30);
+    clist_insert_before(&list, list.head, 5);
+    my_assert(clist_count_nodes(&list) == 4);
+    my_assert(clist_node(list.head)->data == 5);
+    my_assert(clist_node(clist_node(ten)->next)->data == 20);
+    my_assert(list.tail == thirty);
+
+    // The pool is full, but a deleted node is reused
+    clist_insert(&list, 40);
+    my_assert(clist_count_nodes(&list) == 4);
+    clist_delete(&list, 30);
+    my_assert(clist_search(&list, 30) == CLIST_NIL);
+    my_assert(clist_node(list.tail)->data == 20);
+    clist_insert(&list, 40);
+    my_assert(clist_node(list.tail)->data == 40);
+
+    char buffer[64] = {0};
+    FILE *original_stdout = stdout;
+    FILE *fp = tmpfile();
+    stdout = fp;
+    clist_display(&list);
+    fflush(fp);
+    rewind(fp);
+    my_assert(fread(buffer, 1, sizeof(buffer) - 1, fp) > 0);
+    fclose(fp);
+    stdout = original_stdout;
+    my_assert(strcmp(buffer, "[5, 10, 20, 40]") == 0);
+
+    clist_cleanup(&list);
+    my_assert(list.head == CLIST_NIL);
+    printf_green("[PASS].\n");
+}
+
+void test_clist_footprint(int count)
+{
+    printf_yellow("  Testing compact list footprint ---> ");
+    my_assert(sizeof(CNode) == 6);
+
+    // A pool sized for count compact nodes holds count values
+    CList list;
+    clist_init(&list, pool_bytes_for(sizeof(CNode) * count));
+    for (int i = 0; i < count; i++)
+    {
+        clist_insert(&list, i);
+    }
+    my_assert(clist_count_nodes(&list) == count);
+
+    CNodeRef current = list.head;
+    for (int i = 0; i < count; i++)
+    {
+        my_assert(clist_node(current)->data == i);
+        current = clist_node(current)->next;
+    }
+    my_assert(current == CLIST_NIL);
+
+    // Offsets stay valid across the pool, whatever address it lives at
+    my_assert(clist_search(&list, count - 1) == list.tail);
+    my_assert((char *)clist_node(list.tail) == (char *)mem_pool_base() + list.tail);
+
+    clist_cleanup(&list);
+    printf_green("[PASS].\n");
+}
+
+void test_clist_shared(int count)
+{
+    printf_yellow("  Testing compact list shared between processes ---> ");
+    char name[64];
+    snprintf(name, sizeof(name), "/mm_test_list_%d", (int) getpid());
+    mem_unlink_shared(name);
+    my_assert(mem_init_shared(name, sizeof(CNode) * count * 2 + 4096) == 0);
+
+    // The list header lives in the pool too, found through the root
+    CList *list = mem_alloc(sizeof(CList));
+    my_assert(list != NULL);
+    clist_new(list);
+    for (int i = 0; i < count / 2; i++)
+    {
+        clist_insert(list, i);
+    }
+    my_assert(mem_set_root(list) == 0);
+    fflush(stdout);
+
+    // Another process attaches at its own address and appends the rest
+    pid_t child = fork();
+    if (child == 0)
+    {
+        mem_deinit();
+        if (mem_init_shared(name, 0) != 1)
+        {
+            _exit(1);
+        }
+        CList *shared = mem_root();
+        if (shared == NULL || clist_count_nodes(shared) != count / 2)
+        {
+            _exit(2);
+        }
+        for (int i = count / 2; i < count; i++)
+        {
+            clist_insert(shared, i);
+        }
+        mem_deinit();
+        _exit(0);
+    }
+    int status;
+    waitpid(child, &status, 0);
+    my_assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    my_assert(clist_count_nodes(list) == count);
+    CNodeRef current = list->head;
+    for (int i = 0; i < count; i++)
+    {
+        my_assert(clist_node(current)->data == i);
+        current = clist_node(current)->next;
+    }
+    my_assert(current == CLIST_NIL);
+
+    clist_destroy(list);
+    mem_free(list);
+    mem_deinit();
+    my_assert(mem_unlink_shared(name) == 0);
+    printf_green("[PASS].\n");
+}
+
+// ********* Parallel traversal *********
+
+static uint64_t sum_values(uint64_t acc, uint64_t value)
+{
+    return acc + value;
+}
+
+static uint64_t count_odd(uint64_t acc, uint64_t value)
+{
+    return acc + value % 2;
+}
+
+static void count_visit(Node *node, void *ctx)
+{
+    atomic_fetch_add((_Atomic uint64_t *)ctx, node->data);
+}
+
+void test_list_parallel(int count)
+{
+    printf_yellow("  Testing parallel traversal ---> ");
+    Node *head = NULL;
+    uint16_t *values = malloc(count * sizeof(uint16_t));
+    uint64_t expected_sum = 0;
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = (uint16_t)(i % 60000);
+        expected_sum += values[i];
+    }
+    list_from_array(&head, values, count);
+
+    ListIndex index;
+    my_assert(list_index_build(&index, &head, 1000) == 0);
+    my_assert(index.count == (size_t)(count + 999) / 1000);
+
+    my_assert(list_count(&index) == (size_t)count);
+    my_assert(list_reduce(&index, 0, sum_values, sum_values) == expected_sum);
+
+    // Folding and combining differ: count odd values, then add the counts
+    uint64_t expected_odd = 0;
+    for (int i = 0; i < count; i++)
+    {
+        expected_odd += values[i] % 2;
+    }
+    my_assert(list_reduce(&index, 0, count_odd, sum_values) == expected_odd);
+
+    Node *found = list_search_any(&index, values[count - 1]);
+    my_assert(found != NULL && found->data == values[count - 1]);
+    my_assert(list_search_any(&index, 65000) == NULL);
+
+    _Atomic uint64_t visited = 0;
+    list_for_each(&index, count_visit, (void *)&visited);
+    my_assert(atomic_load(&visited) == expected_sum);
+
+    // Same results with a single thread
+    list_parallel_set_threads(1);
+    my_assert(list_count(&index) == (size_t)count);
+    list_parallel_set_threads(0);
+
+    list_index_free(&index);
+    list_parallel_shutdown();
+    list_cleanup(&head);
+    free(values);
+    printf_green("[PASS].\n");
+}
+
 // Main function to run all tests
+// ********* Generic lists *********
+
+typedef struct Point
+{
+    int32_t x;
+    int32_t y;
+} Point;
+
+DEFINE_LIST(point_list, Point)
+DEFINE_LIST(u64_list, uint64_t)
+DEFINE_LIST(ld_list, long double)
+
+// The payload is stored inline: no pointer to a boxed value
+_Static_assert(sizeof(point_list_node) == sizeof(Point) + sizeof(void *), "Point node is not inline");
+_Static_assert(sizeof(u64_list_node) == 2 * sizeof(void *), "uint64_t node is not inline");
+
+static int point_on_diagonal(const Point *p, void *ctx)
+{
+    (void)ctx;
+    return p->x == p->y;
+}
+
+static int u64_equals(const uint64_t *value, void *ctx)
+{
+    return *value == *(uint64_t *)ctx;
+}
+
+void test_generic_list(int count)
+{
+    printf_yellow("  Testing generated generic lists ---> ");
+    point_list points;
+    mem_init(pool_bytes_for(sizeof(point_list_node) * count));
+    my_assert(point_list_new(&points, count) == 0);
+
+    for (int i = 0; i < count; i++)
+    {
+        my_assert(point_list_insert(&points, (Point){i, i % 2 ? i : -i}) != NULL);
+    }
+    // The pool has a fixed size
+    my_assert(point_list_insert(&points, (Point){0, 0}) == NULL);
+    my_assert(point_list_count(&points) == (size_t)count);
+
+    // Odd x are on the diagonal, except that x == 0 also matches
+    size_t removed = point_list_remove_if(&points, point_on_diagonal, NULL);
+    my_assert(removed == (size_t)count / 2 + 1);
+    my_assert(point_list_count(&points) == (size_t)count - removed);
+    my_assert(point_list_find_if(&points, point_on_diagonal, NULL) == NULL);
+
+    int expected = 2;
+    for (point_list_node *n = points.head; n != NULL; n = n->next)
+    {
+        my_assert(n->data.x == expected && n->data.y == -expected);
+        expected += 2;
+    }
+
+    // Released nodes are reused and the tail follows the list
+    my_assert(point_list_insert(&points, (Point){7, 7}) != NULL);
+    my_assert(points.tail->data.x == 7);
+    my_assert(point_list_push_front(&points, (Point){1, 1}) == points.head);
+    Point first;
+    my_assert(point_list_pop_front(&points, &first) && first.x == 1);
+    point_list_destroy(&points);
+
+    // A second list type in the same pool
+    u64_list big;
+    my_assert(u64_list_new(&big, 4) == 0);
+    u64_list_node *a = u64_list_insert(&big, 1ull << 40);
+    u64_list_insert(&big, 3);
+    u64_list_insert_after(&big, a, 2);
+    uint64_t key = 2;
+    my_assert(u64_list_find_if(&big, u64_equals, &key) == a->next);
+    my_assert(big.tail->data == 3);
+    uint64_t value;
+    while (u64_list_pop_front(&big, &value))
+    {
+    }
+    my_assert(big.head == NULL && big.tail == NULL && u64_list_count(&big) == 0);
+    my_assert(u64_list_pop_front(&big, &value) == 0);
+
+    u64_list_cleanup(&big);
+
+    // After an odd-sized block the pool is still aligned for the widest payload
+    mem_init(1024);
+    void *odd = mem_alloc(3);
+    my_assert(odd != NULL);
+    ld_list wide;
+    my_assert(ld_list_new(&wide, 4) == 0);
+    my_assert((uintptr_t)wide.nodes % _Alignof(max_align_t) == 0);
+    for (int i = 0; i < 4; i++)
+    {
+        ld_list_node *n = ld_list_insert(&wide, i / 3.0L);
+        my_assert(n != NULL && (uintptr_t)n % _Alignof(ld_list_node) == 0);
+    }
+    long double wide_value;
+    my_assert(ld_list_pop_front(&wide, &wide_value) && wide_value == 0.0L);
+    mem_free(odd);
+    ld_list_cleanup(&wide);
+    printf_green("[PASS].\n");
+}
+
 int main(int argc, char *argv[])
 {
 
@@ -513,6 +1654,36 @@ int main(int argc, char *argv[])
         printf(" 12. test_list_delete_loop - Test multiple detelions\n");
         printf(" 13. test_list_search_loop - Test multiple search\n");
         printf(" 14. test_list_edge_cases - Test edge cases\n");
+
+        printf("\nBulk Operations:\n");
+        printf(" 15. test_list_insert_array - Test appending an array in one contiguous run\n");
+        printf(" 16. test_list_from_array - Test building a list from an array\n");
+        printf(" 17. test_list_format - Test buffered formatting to memory and file descriptors\n");
+        printf(" 18. test_list_snapshot - Test binary snapshot save and load\n");
+        printf(" 23. test_list_delete_all - Test deleting every occurrence in one pass\n");
+        printf(" 24. test_list_remove_if - Test predicate based remove and retain\n");
+        printf(" 25. test_list_sort - Test the in-place bottom-up merge sort\n");
+        printf(" 26. test_list_sorted_mode - Test sorted insertion and merging of sorted lists\n");
+        printf(" 27. test_list_iterator - Test prefetching cursors, LIST_FOREACH and batches\n");
+        printf(" 28. test_list_compact - Test relayout of scattered nodes and the disorder metric\n");
+        printf(" 30. test_list_growable - Test a list pool that grows without moving nodes\n");
+        printf(" 31. test_list_to_array - Test export to arrays and range callbacks\n");
+
+        printf("\nConcurrent Lists:\n");
+        printf(" 19. test_lf_list_stress - Multi-threaded stress test of the lock-free list\n");
+        printf(" 32. test_rcu_list_stress - Readers without locks against a serialized writer\n");
+        printf(" 34. test_lf_list_alignment - Test the lock-free list after odd-sized allocations\n");
+
+        printf("\nCompact Lists:\n");
+        printf(" 20. test_clist_operations - Test the offset-linked compact list API\n");
+        printf(" 21. test_clist_footprint - Test that compact nodes take 6 bytes each\n");
+        printf(" 33. test_clist_shared - Test a compact list built by two processes\n");
+
+        printf("\nParallel Traversal:\n");
+        printf(" 22. test_list_parallel - Test count, search, reduce and for_each over an index\n");
+
+        printf("\nGeneric Lists:\n");
+        printf(" 29. test_generic_list - Test lists generated by DEFINE_LIST for other payloads\n");
         printf(" 0. Run all tests\n");
 	printf(" 100. Run all tests; -test_list_display() \n");
         return 1;
@@ -540,6 +1711,37 @@ int main(int argc, char *argv[])
         test_list_delete_loop(1000);
         test_list_search_loop(1000);
         test_list_edge_cases();
+
+        printf("\nTesting Bulk Operations:\n");
+        test_list_insert_array(1000);
+        test_list_from_array(1000);
+        test_list_format(100000);
+        test_list_snapshot(10000);
+        test_list_delete_all(10000);
+        test_list_remove_if(10000);
+        test_list_sort(10000);
+        test_list_sorted_mode(1000);
+        test_list_iterator(1000);
+        test_list_compact(10000);
+        test_list_growable(1000);
+        test_list_to_array(1000);
+
+        printf("\nTesting Concurrent Lists:\n");
+        test_lf_list_stress(1, 20000);
+        test_lf_list_stress(8, 20000);
+        test_rcu_list_stress(4, 20000);
+        test_lf_list_alignment(1000);
+
+        printf("\nTesting Compact Lists:\n");
+        test_clist_operations();
+        test_clist_footprint(60000);
+        test_clist_shared(1000);
+
+        printf("\nTesting Parallel Traversal:\n");
+        test_list_parallel(10000);
+
+        printf("\nTesting Generic Lists:\n");
+        test_generic_list(1000);
         break;
     case 0:
         printf("Testing Basic Operations:\n");
@@ -559,6 +1761,37 @@ int main(int argc, char *argv[])
         test_list_delete_loop(1000);
         test_list_search_loop(1000);
         test_list_edge_cases();
+
+        printf("\nTesting Bulk Operations:\n");
+        test_list_insert_array(1000);
+        test_list_from_array(1000);
+        test_list_format(100000);
+        test_list_snapshot(10000);
+        test_list_delete_all(10000);
+        test_list_remove_if(10000);
+        test_list_sort(10000);
+        test_list_sorted_mode(1000);
+        test_list_iterator(1000);
+        test_list_compact(10000);
+        test_list_growable(1000);
+        test_list_to_array(1000);
+
+        printf("\nTesting Concurrent Lists:\n");
+        test_lf_list_stress(1, 20000);
+        test_lf_list_stress(8, 20000);
+        test_rcu_list_stress(4, 20000);
+        test_lf_list_alignment(1000);
+
+        printf("\nTesting Compact Lists:\n");
+        test_clist_operations();
+        test_clist_footprint(60000);
+        test_clist_shared(1000);
+
+        printf("\nTesting Parallel Traversal:\n");
+        test_list_parallel(10000);
+
+        printf("\nTesting Generic Lists:\n");
+        test_generic_list(1000);
         break;
     case 1:
         test_list_init();
@@ -603,6 +1836,66 @@ int main(int argc, char *argv[])
     case 14:
         test_list_edge_cases();
         break;
+    case 15:
+        test_list_insert_array(1000);
+        break;
+    case 16:
+        test_list_from_array(1000);
+        break;
+    case 17:
+        test_list_format(100000);
+        break;
+    case 18:
+        test_list_snapshot(10000);
+        break;
+    case 19:
+        test_lf_list_stress(8, 20000);
+        break;
+    case 20:
+        test_clist_operations();
+        break;
+    case 21:
+        test_clist_footprint(60000);
+        break;
+    case 22:
+        test_list_parallel(10000);
+        break;
+    case 23:
+        test_list_delete_all(10000);
+        break;
+    case 24:
+        test_list_remove_if(10000);
+        break;
+    case 25:
+        test_list_sort(10000);
+        break;
+    case 26:
+        test_list_sorted_mode(1000);
+        break;
+    case 27:
+        test_list_iterator(1000);
+        break;
+    case 28:
+        test_list_compact(10000);
+        break;
+    case 29:
+        test_generic_list(1000);
+        break;
+    case 30:
+        test_list_growable(1000);
+        break;
+    case 31:
+        test_list_to_array(1000);
+        break;
+    case 32:
+        test_rcu_list_stress(4, 20000);
+        break;
+    case 33:
+        test_clist_shared(1000);
+        break;
+    case 34:
+        test_lf_list_alignment(1000);
+        break;
 
     default:
         printf("Invalid test function\n");
@@ -7,6 +7,10 @@
 #include <dlfcn.h>
 #include <sys/mman.h>
 #include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <pthread.h>
 #include "common_defs.h"
 
 #include "gitdata.h"
@@ -331,6 +335,683 @@ void test_edge_case_allocations()
     printf_green("[PASS].\n");
 }
 
+void test_free_batch()
+{
+    printf_yellow("  Testing mem_free_batch ---> ");
+    mem_init(1024);
+
+    // Plain blocks, freed out of order
+    void *blocks[8];
+    for (int i = 0; i < 8; i++)
+    {
+        blocks[i] = mem_alloc(64);
+        my_assert(blocks[i] != NULL);
+    }
+    void *batch[8] = {blocks[5], blocks[0], blocks[7], blocks[2], blocks[1], blocks[6], blocks[4], blocks[3]};
+    mem_free_batch(batch, 8);
+
+    // Elements of a contiguous run, with gaps in between
+    char *run = mem_alloc_contiguous(16, 32);
+    my_assert(run == blocks[0]);
+    void *elements[24];
+    int n = 0;
+    for (int i = 0; i < 32; i++)
+    {
+        if (i % 4 != 1)
+        {
+            elements[n++] = run + i * 16;
+        }
+    }
+    mem_free_batch(elements, n);
+    void *remaining[8];
+    for (int i = 0; i < 8; i++)
+    {
+        remaining[i] = run + (i * 4 + 1) * 16;
+    }
+    mem_free_batch(remaining, 8);
+
+    // Everything was coalesced back into one block
+    void *all = mem_alloc(1024);
+    my_assert(all != NULL);
+    mem_free(all);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_contiguous_odd_size()
+{
+    printf_yellow("  Testing contiguous run of 6-byte elements ---> ");
+    mem_init(1024);
+    mem_reset_errors();
+
+    // Either every element is a block of its own, or the backend refuses the run
+    char *run = mem_alloc_contiguous(6, 10);
+    if (run != NULL)
+    {
+        for (int i = 9; i >= 0; i--)
+        {
+            mem_free(run + i * 6);
+        }
+    }
+    my_assert(mem_error_count(MEM_ERR_FOREIGN_POINTER) == 0);
+    my_assert(mem_error_count(MEM_ERR_DOUBLE_FREE) == 0);
+
+    // Elements of 16 bytes are split on every backend
+    run = mem_alloc_contiguous(16, 10);
+    my_assert(run != NULL);
+    for (int i = 9; i >= 0; i--)
+    {
+        mem_free(run + i * 16);
+    }
+    my_assert(mem_error_count(MEM_ERR_FOREIGN_POINTER) == 0);
+
+    // Freed from the back, everything was coalesced back into one block
+    void *all = mem_alloc(1024);
+    my_assert(all != NULL);
+    mem_free(all);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_growable_pool()
+{
+    printf_yellow("  Testing growable pool ---> ");
+    mem_init_growable(1024, 1 << 20);
+
+    // The first page is in use from the start
+    char *first = mem_alloc(1024);
+    my_assert(first != NULL);
+    memset(first, 0xAB, 1024);
+
+    // Allocations beyond it grow the pool without moving existing blocks
+    char *big = mem_alloc(64 * 1024);
+    my_assert(big != NULL);
+    memset(big, 0xCD, 64 * 1024);
+    my_assert(first == mem_pool_base());
+    my_assert(first[0] == (char)0xAB && first[1023] == (char)0xAB);
+
+    // Reservations succeed up to the limit and fail beyond it
+    my_assert(mem_reserve(256 * 1024) == 0);
+    char *reserved = mem_alloc(256 * 1024);
+    my_assert(reserved != NULL);
+    my_assert(mem_reserve(2 << 20) == -1);
+    my_assert(mem_alloc(2 << 20) == NULL);
+
+    mem_free(reserved);
+    mem_free(big);
+    mem_free(first);
+    mem_deinit();
+
+    // A fixed pool does not grow
+    mem_init(1024);
+    my_assert(mem_reserve(1024) == 0);
+    my_assert(mem_reserve(1025) == -1);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_backend_selection()
+{
+    printf_yellow("  Testing backend selection ---> ");
+    const char *names[] = {"firstfit", "bestfit", "buddy", "tlsf"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        my_assert(mem_set_backend(names[i]) == 0);
+        mem_init(1024);
+        my_assert(strcmp(mem_backend_name(), names[i]) == 0);
+        void *block = mem_alloc(100);
+        my_assert(block != NULL);
+        mem_free(block);
+        mem_deinit();
+    }
+
+    // With holes of 200 and 50 bytes, first-fit takes the first and best-fit the tighter one
+    for (int best = 0; best <= 1; best++) {
+        mem_set_backend(best ? "bestfit" : "firstfit");
+        mem_init(1024);
+        void *wide = mem_alloc(200);
+        void *gap1 = mem_alloc(10);
+        void *narrow = mem_alloc(50);
+        void *gap2 = mem_alloc(10);
+        mem_free(wide);
+        mem_free(narrow);
+        void *block = mem_alloc(50);
+        my_assert(block == (best ? narrow : wide));
+        mem_free(block);
+        mem_free(gap1);
+        mem_free(gap2);
+        mem_deinit();
+    }
+
+    // Unknown names are rejected and NULL goes back to MM_BACKEND
+    my_assert(mem_set_backend("no-such-backend") == -1);
+    my_assert(mem_set_backend(NULL) == 0);
+    printf_green("[PASS].\n");
+}
+
+void test_purge()
+{
+    printf_yellow("  Testing purging of unused free memory ---> ");
+    MemPurgeStats before, freed, after;
+    mem_set_backend("firstfit");
+    mem_init(1 << 20);
+    mem_purge_stats(&before);
+
+    // A freshly freed block is kept until it has been unused for the decay time
+    char *block = mem_alloc(512 * 1024);
+    my_assert(block != NULL);
+    memset(block, 0xAB, 512 * 1024);
+    mem_free(block);
+    mem_purge_stats(&freed);
+    my_assert(mem_purge(60000) == 0);
+    my_assert(mem_purge(0) >= 256 * 1024);
+    mem_purge_stats(&after);
+    my_assert(after.ranges > before.ranges);
+    my_assert(after.bytes >= before.bytes + 256 * 1024);
+    my_assert(after.released_bytes >= freed.released_bytes + 256 * 1024);
+
+    // Reusing purged memory takes it out of the released count
+    block = mem_alloc(1 << 20);
+    my_assert(block != NULL);
+    memset(block, 0xCD, 1 << 20);
+    mem_purge_stats(&after);
+    my_assert(after.released_bytes == 0);
+    mem_free(block);
+
+    // The background thread purges without any call from the program
+    my_assert(mem_purge_start(10) == 0);
+    mem_purge_stats(&before);
+    struct timespec pause = {0, 10 * 1000 * 1000};
+    for (int i = 0; i < 200 && after.bytes == before.bytes; i++) {
+        nanosleep(&pause, NULL);
+        mem_purge_stats(&after);
+    }
+    mem_purge_stop();
+    my_assert(after.bytes > before.bytes);
+    my_assert(after.passes > before.passes);
+
+    mem_deinit();
+    mem_set_backend(NULL);
+    printf_green("[PASS].\n");
+}
+
+void test_large_objects()
+{
+    printf_yellow("  Testing large objects outside the pool ---> ");
+    mem_set_large_threshold(64 * 1024);
+    mem_init(4096);
+
+    // Large requests get their own page-aligned mapping, the small pool is untouched
+    char *big = mem_alloc(1 << 20);
+    my_assert(big != NULL);
+    my_assert(((size_t) big & 4095) == 0);
+    memset(big, 0xAB, 1 << 20);
+    void *small = mem_alloc(4096);
+    my_assert(small != NULL);
+
+    // Resizing keeps the contents while growing and shrinking
+    big = mem_resize(big, 8 << 20);
+    my_assert(big != NULL);
+    my_assert(big[0] == (char)0xAB && big[(1 << 20) - 1] == (char)0xAB);
+    memset(big + (1 << 20), 0xCD, 7 << 20);
+    big = mem_resize(big, 100);
+    my_assert(big != NULL);
+    my_assert(big[0] == (char)0xAB && big[99] == (char)0xAB);
+
+    void *batch[3] = {mem_alloc(128 * 1024), small, mem_alloc(256 * 1024)};
+    my_assert(batch[0] != NULL && batch[2] != NULL);
+    mem_free_batch(batch, 3);
+    my_assert(mem_alloc(4096) == small);
+    mem_free(small);
+
+    // A pool block that grows past the threshold moves out once and keeps its contents
+    char *grown = mem_alloc(1000);
+    my_assert(grown != NULL);
+    for (int i = 0; i < 1000; i++)
+    {
+        grown[i] = (char)(i * 7);
+    }
+    grown = mem_resize(grown, 128 * 1024);
+    my_assert(grown != NULL && ((size_t) grown & 4095) == 0);
+    for (int i = 0; i < 1000; i++)
+    {
+        my_assert(grown[i] == (char)(i * 7));
+    }
+    memset(grown + 1000, 0x5A, 128 * 1024 - 1000);
+    grown = mem_resize(grown, 4 << 20);
+    my_assert(grown != NULL && grown[999] == (char)(999 * 7) && grown[128 * 1024 - 1] == 0x5A);
+    // Its pool block was freed, so the whole pool is available again
+    void *whole = mem_alloc(4096);
+    my_assert(whole != NULL);
+    mem_free(whole);
+    mem_free(grown);
+
+    // Many large blocks at once, freed and moved in an order unrelated to allocation
+    mem_reset_errors();
+    char *many[100];
+    for (int i = 0; i < 100; i++)
+    {
+        many[i] = mem_alloc(64 * 1024);
+        my_assert(many[i] != NULL);
+        many[i][0] = (char)i;
+    }
+    for (int i = 0; i < 100; i += 3)
+    {
+        many[i] = mem_resize(many[i], 256 * 1024);
+        my_assert(many[i] != NULL && many[i][0] == (char)i);
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        int j = (i * 37) % 100;
+        my_assert(many[j][0] == (char)j);
+        mem_free(many[j]);
+    }
+    my_assert(mem_error_count(MEM_ERR_FOREIGN_POINTER) == 0);
+
+    // Blocks still live at mem_deinit go with the pool
+    mem_deinit();
+    mem_set_large_threshold(0);
+    printf_green("[PASS].\n");
+}
+
+static int all_zero(const char *block, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        if (block[i] != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void test_calloc()
+{
+    printf_yellow("  Testing mem_calloc ---> ");
+    mem_init(1 << 20);
+    my_assert(mem_calloc((size_t) -1 / 2, 4) == NULL);
+
+    // Fresh memory reads as zero
+    char *fresh = mem_calloc(100, 1000);
+    my_assert(fresh != NULL && all_zero(fresh, 100000));
+    mem_free(fresh);
+
+    // Memory that was written and freed is cleared again
+    char *dirty = mem_alloc(3 * 4096 + 100);
+    my_assert(dirty != NULL);
+    memset(dirty, 0xFF, 3 * 4096 + 100);
+    mem_free(dirty);
+    char *zeroed = mem_calloc(3 * 4096 + 100, 1);
+    my_assert(zeroed != NULL && all_zero(zeroed, 3 * 4096 + 100));
+
+    // And so is memory that was purged after being written
+    memset(zeroed, 0xFF, 3 * 4096 + 100);
+    mem_free(zeroed);
+    mem_purge(0);
+    zeroed = mem_calloc(1, 3 * 4096 + 100);
+    my_assert(zeroed != NULL && all_zero(zeroed, 3 * 4096 + 100));
+    mem_free(zeroed);
+    mem_deinit();
+
+    // A freed middle element of a run starts unaligned and spans whole pages
+    mem_init(27000);
+    char *run = mem_alloc_contiguous(9000, 3);
+    if (run != NULL)
+    {
+        memset(run, 0xFF, 27000);
+        mem_free(run + 9000);
+        char *inside = mem_calloc(1, 100);
+        my_assert(inside != NULL && all_zero(inside, 100));
+    }
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_file_pool()
+{
+    printf_yellow("  Testing file-backed pool ---> ");
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/mm_test_pool_%d", (int) getpid());
+    unlink(path);
+
+    // A new file gets an empty pool
+    my_assert(mem_init_file(path, 1 << 20) == 0);
+    char *text = mem_alloc(64);
+    my_assert(text != NULL);
+    strcpy(text, "persistent");
+    my_assert(mem_set_root(text) == 0);
+    char *kept = mem_alloc(1000);
+    my_assert(kept != NULL);
+    size_t kept_offset = kept - (char *) mem_pool_base();
+    mem_deinit();
+
+    // Reopening finds the root and leaves earlier blocks allocated
+    my_assert(mem_init_file(path, 0) == 1);
+    text = mem_root();
+    my_assert(text != NULL && strcmp(text, "persistent") == 0);
+    char *fresh = mem_alloc(1000);
+    my_assert(fresh != NULL && fresh != text && fresh - (char *) mem_pool_base() != kept_offset);
+    mem_free(fresh);
+    mem_deinit();
+
+    // A process that exits without mem_deinit leaves the pool marked as not clean
+    pid_t child = fork();
+    if (child == 0) {
+        mem_init_file(path, 0);
+        mem_alloc(100);
+        _exit(0);
+    }
+    waitpid(child, NULL, 0);
+    my_assert(mem_init_file(path, 0) == 2);
+    my_assert(strcmp(mem_root(), "persistent") == 0);
+    mem_deinit();
+
+    // Damaged block tags fail the check and the pool is recreated
+    int fd = open(path, O_WRONLY);
+    char garbage[256];
+    memset(garbage, 0xFF, sizeof(garbage));
+    my_assert(pwrite(fd, garbage, sizeof(garbage), 4096) == (ssize_t) sizeof(garbage));
+    close(fd);
+    my_assert(mem_init_file(path, 0) == 0);
+    my_assert(mem_root() == NULL);
+    my_assert(mem_alloc(1 << 19) != NULL);
+    mem_deinit();
+
+    unlink(path);
+    printf_green("[PASS].\n");
+}
+
+// Allocates and frees blocks of varying size, keeping up to 16 alive at a time
+static void churn(int rounds, unsigned seed)
+{
+    void *live[16] = {NULL};
+    for (int i = 0; rounds < 0 || i < rounds; i++) {
+        int slot = rand_r(&seed) % 16;
+        if (live[slot] != NULL) {
+            mem_free(live[slot]);
+        }
+        live[slot] = mem_alloc(16 + rand_r(&seed) % 2000);
+    }
+    for (int slot = 0; slot < 16; slot++) {
+        if (live[slot] != NULL) {
+            mem_free(live[slot]);
+        }
+    }
+}
+
+void test_shared_pool()
+{
+    printf_yellow("  Testing shared-memory pool across processes ---> ");
+    char name[64];
+    snprintf(name, sizeof(name), "/mm_test_pool_%d", (int) getpid());
+    mem_unlink_shared(name);
+    my_assert(mem_init_shared(name, 1 << 20) == 0);
+    fflush(stdout);
+
+    // Two processes allocate from the same pool at once
+    pid_t child = fork();
+    if (child == 0) {
+        if (mem_init_shared(name, 0) != 1) {
+            _exit(1);
+        }
+        churn(20000, 1);
+        mem_deinit();
+        _exit(0);
+    }
+    churn(20000, 2);
+    int status;
+    waitpid(child, &status, 0);
+    my_assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // Every block came back and was coalesced, so the whole pool is one block again
+    void *all = mem_alloc(1 << 20);
+    my_assert(all != NULL);
+    mem_free(all);
+
+    // A process killed in the middle of allocating does not block the others
+    child = fork();
+    if (child == 0) {
+        mem_init_shared(name, 0);
+        churn(-1, 3);
+        _exit(0);
+    }
+    struct timespec pause = {0, 20 * 1000 * 1000};
+    nanosleep(&pause, NULL);
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+    churn(1000, 4);
+
+    mem_deinit();
+    my_assert(mem_unlink_shared(name) == 0);
+    printf_green("[PASS].\n");
+}
+
+static void *defer_worker(void *arg)
+{
+    unsigned seed = (unsigned) (size_t) arg;
+    for (int i = 0; i < 20000; i++) {
+        void *block = mem_alloc(16 + rand_r(&seed) % 200);
+        if (block != NULL) {
+            mem_free_deferred(block);
+        }
+    }
+    return NULL;
+}
+
+void test_free_deferred()
+{
+    printf_yellow("  Testing deferred free ---> ");
+    mem_init(1 << 20);
+
+    // Nothing is freed until a drain, but a failing allocation drains first
+    void *blocks[1000];
+    for (int i = 0; i < 1000; i++) {
+        blocks[i] = mem_alloc(100);
+        my_assert(blocks[i] != NULL);
+    }
+    for (int i = 0; i < 1000; i++) {
+        mem_free_deferred(blocks[i]);
+    }
+    void *all = mem_alloc(1 << 20);
+    my_assert(all != NULL);
+    mem_free(all);
+
+    // Threads defer their frees while the reclaimer empties full buffers
+    my_assert(mem_reclaimer_start() == 0);
+    pthread_t threads[4];
+    for (int t = 0; t < 4; t++) {
+        my_assert(pthread_create(&threads[t], NULL, defer_worker, (void *) (size_t) (t + 1)) == 0);
+    }
+    for (int t = 0; t < 4; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    mem_reclaimer_stop();
+
+    // Partial buffers of exited threads are queued, one drain frees everything
+    mem_free_drain();
+    all = mem_alloc(1 << 20);
+    my_assert(all != NULL);
+    mem_free(all);
+
+    // Blocks still queued at mem_deinit are dropped, not freed into the next pool
+    mem_free_deferred(mem_alloc(100));
+    mem_deinit();
+    mem_init(1024);
+    mem_free_drain();
+    my_assert(mem_alloc(1024) != NULL);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+static void count_event(const MemEvent *event, void *ctx)
+{
+    (void) event;
+    __atomic_fetch_add((int *) ctx, 1, __ATOMIC_RELAXED);
+}
+
+static void *report_worker(void *arg)
+{
+    (void) arg;
+    for (int i = 0; i < 1000; i++) {
+        mem_free(NULL);
+    }
+    return NULL;
+}
+
+void test_error_reporting()
+{
+    printf_yellow("  Testing error reporting ---> ");
+    mem_set_error_output(0);
+    mem_reset_errors();
+    int seen = 0;
+    mem_set_error_callback(count_event, &seen);
+
+    // Every misuse is counted per code and lands in the ring in order
+    mem_init(1024);
+    int local = 0;
+    void *block = mem_alloc(100);
+    my_assert(block != NULL);
+    mem_free(block);
+    mem_free(block);
+    mem_free(NULL);
+    mem_free(&local);
+    my_assert(mem_error_count(MEM_ERR_DOUBLE_FREE) == 1);
+    my_assert(mem_error_count(MEM_ERR_NULL_FREE) == 1);
+    my_assert(mem_error_count(MEM_ERR_FOREIGN_POINTER) == 1);
+    my_assert(mem_last_error() == MEM_ERR_FOREIGN_POINTER);
+    my_assert(mem_resize(&local, 10) == NULL);
+    my_assert(mem_error_count(MEM_ERR_RESIZE_UNKNOWN) == 1);
+    my_assert(seen == 4);
+
+    MemEvent events[300];
+    size_t n = mem_recent_errors(events, 4);
+    my_assert(n == 4);
+    my_assert(events[0].code == MEM_ERR_DOUBLE_FREE && events[0].ptr == block);
+    my_assert(events[1].code == MEM_ERR_NULL_FREE);
+    my_assert(events[2].code == MEM_ERR_FOREIGN_POINTER && events[2].ptr == &local);
+    my_assert(events[3].code == MEM_ERR_RESIZE_UNKNOWN);
+    my_assert(events[0].time_ns <= events[3].time_ns);
+    mem_deinit();
+
+    // Threads report at once without losing counts; the ring keeps the latest 256
+    mem_set_error_callback(NULL, NULL);
+    pthread_t threads[4];
+    for (int t = 0; t < 4; t++) {
+        my_assert(pthread_create(&threads[t], NULL, report_worker, NULL) == 0);
+    }
+    for (int t = 0; t < 4; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    my_assert(mem_error_count(MEM_ERR_NULL_FREE) == 4001);
+    my_assert(seen == 4);
+    my_assert(mem_recent_errors(events, 300) == 256);
+
+    // A burst prints only a few lines to stderr
+    fflush(stderr);
+    int saved = dup(2);
+    FILE *capture = tmpfile();
+    my_assert(capture != NULL);
+    dup2(fileno(capture), 2);
+    mem_set_error_output(2);
+    for (int i = 0; i < 100; i++) {
+        mem_free(NULL);
+    }
+    fflush(stderr);
+    dup2(saved, 2);
+    close(saved);
+    rewind(capture);
+    int lines = 0;
+    for (int c; (c = fgetc(capture)) != EOF;) {
+        lines += c == '\n';
+    }
+    fclose(capture);
+    my_assert(lines >= 2 && lines <= 5);
+
+    mem_set_error_output(10);
+    mem_reset_errors();
+    my_assert(mem_error_count(MEM_ERR_NULL_FREE) == 0);
+    printf_green("[PASS].\n");
+}
+
+// Kept out of line so its address shows up in the sampled stacks
+__attribute__((noinline)) static void *profiled_alloc(size_t size)
+{
+    return mem_alloc(size);
+}
+
+void test_heap_profile()
+{
+    printf_yellow("  Testing sampling heap profiler ---> ");
+    mem_init(1 << 20);
+    my_assert(mem_profile_start(4096) == 0);
+
+    MemProfileStats before, stats;
+    mem_profile_stats(&before);
+    void *blocks[4000];
+    for (int i = 0; i < 4000; i++) {
+        blocks[i] = profiled_alloc(100);
+        my_assert(blocks[i] != NULL);
+    }
+    // About 100 samples for 400 KB at one per 4 KB
+    mem_profile_stats(&stats);
+    my_assert(stats.samples - before.samples > 40);
+    my_assert(stats.samples - before.samples < 250);
+    my_assert(stats.live_samples == stats.samples - before.samples);
+    my_assert(stats.live_bytes == stats.live_samples * 100);
+
+    // Freed blocks stop being live, however they are freed
+    for (int i = 0; i < 2000; i++) {
+        mem_free(blocks[i]);
+    }
+    mem_free_batch(blocks + 2000, 1000);
+    for (int i = 3000; i < 4000; i++) {
+        mem_free_deferred(blocks[i]);
+    }
+    mem_profile_stats(&stats);
+    my_assert(stats.live_samples == 0);
+
+    // A dump on request is a legacy pprof heap profile
+    for (int i = 0; i < 1000; i++) {
+        blocks[i] = profiled_alloc(100);
+    }
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/mm_profile_%d.heap", (int) getpid());
+    my_assert(mem_profile_dump(path) == 0);
+    FILE *file = fopen(path, "r");
+    my_assert(file != NULL);
+    char line[512];
+    my_assert(fgets(line, sizeof(line), file) != NULL);
+    my_assert(strncmp(line, "heap profile: ", 14) == 0);
+    my_assert(strstr(line, "@ heap_v2/4096") != NULL);
+    int mapped = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        mapped |= strcmp(line, "MAPPED_LIBRARIES:\n") == 0;
+    }
+    fclose(file);
+    my_assert(mapped);
+    unlink(path);
+
+    // And so is one triggered by a signal, written by a helper thread
+    char prefix[64];
+    snprintf(prefix, sizeof(prefix), "/tmp/mm_profile_sig_%d", (int) getpid());
+    my_assert(mem_profile_dump_on_signal(SIGUSR1, prefix) == 0);
+    raise(SIGUSR1);
+    snprintf(path, sizeof(path), "%s.%d.0.heap", prefix, (int) getpid());
+    int found = 0;
+    for (int tries = 0; tries < 100 && !found; tries++) {
+        usleep(10000);
+        found = access(path, F_OK) == 0;
+    }
+    mem_profile_dump_on_signal_stop();
+    my_assert(found);
+    unlink(path);
+
+    // The pool going away ends every sample in it
+    mem_profile_stop();
+    mem_deinit();
+    mem_profile_stats(&stats);
+    my_assert(stats.live_samples == 0);
+    printf_green("[PASS].\n");
+}
+
 void test_looking_for_out_of_bounds(int size){
   printf("  Testing outofbounds (errors not tracked/detected here) \n");
   if (size<5000) {
@@ -447,6 +1128,22 @@ int main(int argc, char *argv[])
         printf(" 19. test_init, but large memory - Initialize memory system\n");
 	printf(" 20. test_looking_for_out_of_bounds, needs LD_PRELOAD=./libmymalloc.so .Needs argument of size.\n\n");
 	printf(" 21. test_mmap, needs LD_PRELOAD=./libmymalloc.so .\n\n");
+
+        printf("\nBatch Operations:\n");
+        printf(" 22. test_free_batch - Free many blocks with one pass and coalesce\n");
+        printf(" 23. test_growable_pool - Grow the pool on demand without moving blocks\n");
+        printf(" 33. test_contiguous_odd_size - Split or refuse runs of elements that are not 16-byte multiples\n");
+
+        printf("\nBackends:\n");
+        printf(" 24. test_backend_selection - Choose the allocation strategy at run time\n");
+        printf(" 25. test_purge - Hand unused free memory back to the OS after a decay time\n");
+        printf(" 26. test_large_objects - Map large requests on their own and resize them with mremap\n");
+        printf(" 27. test_calloc - Zeroed allocations that skip clearing memory known to be zero\n");
+        printf(" 28. test_file_pool - Reopen a pool kept in a file\n");
+        printf(" 29. test_shared_pool - Allocate from one pool in several processes\n");
+        printf(" 30. test_free_deferred - Queue frees per thread and free them in batches\n");
+        printf(" 31. test_error_reporting - Count errors, keep recent ones and rate-limit output\n");
+        printf(" 32. test_heap_profile - Sample allocations with their call stacks and dump them for pprof\n\n");
 	
         printf(" 0. Run all tests (excluding 20)\n");
         return 1;
@@ -485,6 +1182,22 @@ int main(int argc, char *argv[])
         test_zero_alloc_and_free();
         test_random_blocks();
 	test_init(1048576);
+
+        printf("\nTesting Batch Operations:\n");
+        test_free_batch();
+        test_growable_pool();
+
+        printf("\nTesting Backends:\n");
+        test_backend_selection();
+        test_purge();
+        test_large_objects();
+        test_calloc();
+        test_file_pool();
+        test_shared_pool();
+        test_free_deferred();
+        test_error_reporting();
+        test_heap_profile();
+        test_contiguous_odd_size();
         break;
     case 1:
         test_init(1024);
@@ -552,6 +1265,42 @@ int main(int argc, char *argv[])
       printf("Test 21.\n");
       test_mmap();
       break;
+    case 22:
+      test_free_batch();
+      break;
+    case 23:
+      test_growable_pool();
+      break;
+    case 24:
+      test_backend_selection();
+      break;
+    case 25:
+      test_purge();
+      break;
+    case 26:
+      test_large_objects();
+      break;
+    case 27:
+      test_calloc();
+      break;
+    case 28:
+      test_file_pool();
+      break;
+    case 29:
+      test_shared_pool();
+      break;
+    case 30:
+      test_free_deferred();
+      break;
+    case 31:
+      test_error_reporting();
+      break;
+    case 32:
+      test_heap_profile();
+      break;
+    case 33:
+      test_contiguous_odd_size();
+      break;
     default:
       printf("Invalid test function\n");
       break;